@@ -28,13 +28,31 @@ bool Action::yesno(const char *request, bool defval,
 }
 
 
+size_t Action::readLine(Stream &stream, char *&line, size_t &nline) {
+  size_t n = stream.readBytesUntil('\n', line, nline);
+  // a full buffer has not consumed the end of the line:
+  while (n + 1 >= nline) {
+    char *buffer = (char *)realloc(line, 2*nline);
+    if (buffer == NULL)
+      break;
+    line = buffer;
+    n += stream.readBytesUntil('\n', line + n, nline + 1);
+    nline *= 2;
+  }
+  return n;
+}
+
+
 Action::Action(const char *name, unsigned int roles, Modes mode) :
   Mode(mode),
   Name(const_cast<char *>(name)),
   SupportedRoles(roles),
   Roles(roles),
   Parent(NULL),
-  Root(NULL) {
+  Root(NULL),
+  OnChange(NULL),
+  OnChangeContext(NULL),
+  Changed(false) {
 }
 
 
@@ -53,6 +71,8 @@ Action::~Action() {
 void Action::setName(const char *name) {
   Name = new char[strlen(name) + 1];
   strcpy(Name, name);
+  if (Root != NULL)
+    Root->invalidateFingerprint();
 }
 
 
@@ -101,12 +121,16 @@ bool Action::disabled(unsigned int roles) const {
 void Action::enable(unsigned int roles) {
   roles &= SupportedRoles;
   Roles |= roles;
+  if (Root != NULL)
+    Root->invalidateFingerprint();
 }
 
 
 void Action::disable(unsigned int roles) {
   roles &= SupportedRoles;
   Roles &= ~roles;
+  if (Root != NULL)
+    Root->invalidateFingerprint();
 }
 
 
@@ -114,12 +138,16 @@ void Action::disableSupported(unsigned int roles) {
   roles &= SupportedRoles;
   SupportedRoles &= ~roles;
   Roles &= SupportedRoles;
+  if (Root != NULL)
+    Root->invalidateFingerprint();
 }
 
 
 void Action::setRoles(unsigned int roles) {
   SupportedRoles = roles;
   Roles = roles;
+  if (Root != NULL)
+    Root->invalidateFingerprint();
 }
 
 
@@ -179,9 +207,19 @@ int Action::put(int addr, Storage &storage, Stream &stream) const {
 }
 
 
-int Action::get(int addr, bool setvalue,
+int Action::get(int addr0, int addr1,
 		Storage &storage, Stream &stream) {
-  return addr;
+  return 0;
+}
+
+
+size_t Action::storageSize() const {
+  return 0;
+}
+
+
+uint32_t Action::fingerprint(uint32_t hash) const {
+  return hash;
 }
 
 
@@ -194,3 +232,36 @@ int Action::receive(Storage &storage, Stream &stream) {
   return 0;
 }
 
+
+void Action::setOnChange(ChangeCallback callback, void *context) {
+  OnChange = callback;
+  OnChangeContext = context;
+}
+
+
+int Action::snapshotAddress(const Action *action, int addr) const {
+  return action == this ? addr : -1;
+}
+
+
+void Action::notifyChange() {
+  bool defer = (Root != NULL && Root->deferChanges());
+  for (Action *act = this; act != NULL; act = act->Parent) {
+    if (act->OnChange == NULL)
+      continue;
+    if (defer)
+      act->Changed = true;
+    else
+      act->OnChange(*act, act->OnChangeContext);
+  }
+}
+
+
+void Action::notifyChanges() {
+  if (!Changed)
+    return;
+  Changed = false;
+  if (OnChange != NULL)
+    OnChange(*this, OnChangeContext);
+}
+
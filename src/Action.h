@@ -35,6 +35,7 @@ class Action {
     BusTransmit = 256,   // transmit via bus using transmit() function.
     BusReceive = 512,    // receive from bus using get() function.
     BusIO = BusTransmit | BusReceive,
+    NonDefault = 1024,   // write() only values differing from their defaults.
     ActionRoles = StreamInput,         // Action that can execute
     ReportRoles = StreamIO | Report,   // Action that can execute and report
     ParameterRoles = SetValue | FileIO | StreamIO | StorageIO | BusIO | Report,
@@ -57,10 +58,22 @@ class Action {
     MainMenuType = 12    // Action is the main menu (Config class).
   };
 
+  /* Function called on changes of an action.
+     action is the action the function was registered on,
+     context the pointer passed to setOnChange(). */
+  typedef void (*ChangeCallback)(Action &action, void *context);
+
   /* Ask a yes or no question on a serial I/O stream. */
   static bool yesno(const char *request, bool defval=true,
 		    bool echo=true, Stream &stream=Serial);
 
+  /* Read a line of any length from stream into line of size nline.
+     Lines that do not fit are read into a larger buffer obtained from
+     realloc(), so line needs to be allocated by malloc(), and nline is
+     updated accordingly.
+     Return the length of the line. */
+  static size_t readLine(Stream &stream, char *&line, size_t &nline);
+
   /* Initialize action with name and supported roles and mode.
      Warning: only a pointer to name is stored.
      That is, name must be a static character array.
@@ -210,9 +223,25 @@ class Action {
   /* Parse the string val and configure the action accordingly.
      SetValue must be enabled. If StreamOutput is enabled,
      report the new value together with name on stream.
-     name is the parent's Menu name. */
-  virtual void set(const char *val, const char *name=0,
-		   Stream &stream=Serial) {};
+     name is the parent's Menu name.
+     Return false if val was not valid.
+     Default implementation does nothing and returns true. */
+  virtual bool set(const char *val, const char *name=0,
+		   Stream &stream=Serial) { return true; };
+
+  /* True if name is a key that set() configures, i.e. a key in the
+     section of this action in a configuration file.
+     Default implementation returns false. */
+  virtual bool hasKey(const char *name) const { return false; };
+  
+  /* True if all values of this action equal their defaults.
+     Default implementation returns true. */
+  virtual bool isDefault() const { return true; };
+
+  /* Set all values of this action back to their defaults,
+     if SetValue is enabled.
+     Default implementation does nothing. */
+  virtual void resetDefaults() {};
   
   /* Write configuration with role StoragePut to addr in storage memory.
      Report errors and success on stream.
@@ -221,14 +250,44 @@ class Action {
   virtual int put(int addr, Storage &storage,
 		  Stream &stream=Serial) const;
   
-  /* Read configuration with role StorageGet from addr in storage memory.
-     Only if setvalue is true set the action's value to content from storage.
+  /* Read configuration with role StorageGet from the records stored
+     between addr0 and addr1 in storage memory.
      Report errors and success on stream.
-     Returns address behind this configuration, -1 on error.
-     Default implementation returns addr. */
-  virtual int get(int addr, bool setvalue,
+     Returns the number of values read, -1 on error.
+     Default implementation returns 0. */
+  virtual int get(int addr0, int addr1,
 		  Storage &storage, Stream &stream=Serial);
 
+  /* Number of bytes put() writes to storage memory.
+     Default implementation returns 0. */
+  virtual size_t storageSize() const;
+
+  /* Update hash with the key, type, and size of the values this action
+     writes to storage memory via put().
+     Default implementation returns hash. */
+  virtual uint32_t fingerprint(uint32_t hash) const;
+
+  /* Number of bytes snapshot() writes.
+     Default implementation returns 0. */
+  virtual size_t snapshotSize() const { return 0; };
+
+  /* Address of the values of action within the values snapshot()
+     writes to addr, -1 if action is neither this action nor one of
+     its children. */
+  virtual int snapshotAddress(const Action *action, int addr) const;
+
+  /* Write the values of this action in their binary representation,
+     without any record headers, to addr in storage memory.
+     Returns address behind the values, -1 on error.
+     Default implementation returns addr. */
+  virtual int snapshot(int addr, Storage &storage) const { return addr; };
+
+  /* Read the values written by snapshot() from addr in storage memory
+     and set the values of this action accordingly, if SetValue is enabled.
+     Returns address behind the values, -1 on error.
+     Default implementation returns addr. */
+  virtual int restore(int addr, Storage &storage) { return addr; };
+
   /* Transmit configuration with role BusTransmit using storage.
      Returns a negative number on error, 0 if this action does not
      transmit anything (default implementation), and a positive number
@@ -241,6 +300,20 @@ class Action {
      Does nothing and return zero if action does not accept values (default). */
   virtual int receive(Storage &storage, Stream &stream=Serial);
 
+  /* Call callback with context whenever the value of this action,
+     or of any action contained in this menu, effectively changes.
+     Pass NULL to remove the callback. */
+  void setOnChange(ChangeCallback callback, void *context=0);
+
+  /* Notify the callbacks of this action and of all its parent menus
+     about a change of this action.
+     If the root menu defers changes, just mark the actions as changed. */
+  void notifyChange();
+
+  /* Call the callback of this action if it has been marked as changed
+     and clear the mark. */
+  virtual void notifyChanges();
+
   
  protected:
 
@@ -252,6 +325,10 @@ class Action {
 
   Menu *Parent;
   Config *Root;
+
+  ChangeCallback OnChange;
+  void *OnChangeContext;
+  bool Changed;
   
 };
 
@@ -0,0 +1,589 @@
+/*
+  ArrayParameter - Parameters whose values are arrays of numbers or strings.
+
+  Instead of configuring per-channel settings, like gains or channel
+  names, by many separate parameters, an array parameter holds all
+  values in a single contiguous array. It occupies a single menu entry
+  and a single record in storage memory that is written and read at
+  once.
+
+  In configuration files and in the interactive menu, the values are
+  written and parsed as YAML flow sequences, like "[1, 2, 4, 8]".
+  Values are only set if all elements are valid.
+
+  Classes:
+
+  - NumberArrayParameter: A parameter whose value is an array of N numbers with optional unit.
+  - StringArrayParameter: A parameter whose value is an array of N strings of size M.
+*/
+
+#ifndef ArrayParameter_h
+#define ArrayParameter_h
+
+
+#include <Parameter.h>
+
+
+/* A parameter whose value is an array of N numbers with optional unit. */
+template<class T, int N>
+class NumberArrayParameter : public BaseNumberParameter<T> {
+
+ public:
+
+  /* Initialize parameter with identifying name, N values,
+     format string, and unit, and add it to menu. */
+  NumberArrayParameter(Menu &menu, const char *name, const T (&values)[N],
+		       const char *format, const char *unit=0,
+		       const char *outunit=0, Action::Modes mode=Action::User);
+
+  /* Initialize parameter with identifying name, N values,
+     minimum, maximum, format string, and unit, and add it to menu. */
+  NumberArrayParameter(Menu &menu, const char *name, const T (&values)[N],
+		       T minimum, T maximum, const char *format,
+		       const char *unit=0, const char *outunit=0,
+		       Action::Modes mode=Action::User);
+
+  /* Number of elements of the array. */
+  size_t size() const { return N; };
+
+  /* Return the i-th number. */
+  T value(size_t i) const { return Values[i]; };
+
+  /* Return the i-th number in unit. */
+  T value(size_t i, const char *unit) const;
+
+  /* Return all numbers. */
+  const T *values() const { return Values; };
+
+  /* Set the i-th number to val, if it is within the valid range. */
+  void setValue(size_t i, T val);
+
+  /* Set the i-th number to val given in unit, if it is within
+     the valid range after conversion to the internal unit. */
+  void setValue(size_t i, T val, const char *unit);
+
+  /* Parse the YAML flow sequence of exactly N numbers in val
+     and set the values of this parameter accordingly.
+     Return true if all numbers were valid or the parameter was disabled. */
+  virtual bool parseValue(char *val, bool selection=false);
+
+  /* Return the current values of this parameter as a string. */
+  virtual void valueStr(char *str) const;
+
+  /* Write all values to stream. */
+  virtual size_t writeValue(Stream &stream) const;
+
+  /* The type of the value as stored in storage memory. */
+  virtual Parameter::ValueType valueType() const;
+
+  /* The size of the value in bytes as stored in storage memory. */
+  virtual size_t valueSize() const { return N*sizeof(T); };
+
+  /* Copy the N numbers in their internal unit into dest. */
+  virtual bool getRaw(void *dest, size_t size) const;
+
+  /* Set the N numbers from src given in their internal unit,
+     if all of them are within the valid range. */
+  virtual bool setRaw(const void *src, size_t size);
+
+  /* Return in str the type of the value. */
+  virtual void typeStr(char *str) const;
+
+  /* True if all numbers equal their defaults. */
+  virtual bool isDefault() const;
+
+  /* Set all numbers back to their defaults. */
+  virtual void resetDefaults();
+
+
+ protected:
+
+  /* Write values to addr in storage memory. */
+  virtual int putValue(int addr, Storage &storage) const;
+
+  /* Read values of size bytes from addr in storage memory. */
+  virtual int getValue(int addr, size_t size, Storage &storage);
+
+  /* Copy vals to the values and notify about the change
+     if they differ. */
+  void changeValues(const T (&vals)[N]);
+
+  T Values[N];
+  T Defaults[N];
+
+};
+
+
+/* A parameter whose value is an array of N strings of size M. */
+template<int N, int M>
+class StringArrayParameter : public Parameter {
+
+ public:
+
+  /* Initialize parameter with identifying name, N strings,
+     and add it to menu. */
+  StringArrayParameter(Menu &menu, const char *name,
+		       const char *const (&strs)[N],
+		       Action::Modes mode=Action::User);
+
+  /* Number of elements of the array. */
+  size_t size() const { return N; };
+
+  /* Return the i-th string. */
+  const char *value(size_t i) const { return Values[i]; };
+
+  /* Set the i-th string to val. Strings containing both single
+     and double quotes cannot be written to a YAML flow sequence
+     and are rejected.
+     Return true if the string was set or the parameter was disabled. */
+  bool setValue(size_t i, const char *val);
+
+  /* Parse the YAML flow sequence of exactly N strings in val
+     and set the values of this parameter accordingly. Items
+     containing both single and double quotes are rejected.
+     Return true if val was a valid sequence or the parameter was disabled. */
+  virtual bool parseValue(char *val, bool selection=false);
+
+  /* Return the current values of this parameter as a string. */
+  virtual void valueStr(char *str) const;
+
+  /* Write all values to stream. */
+  virtual size_t writeValue(Stream &stream) const;
+
+  /* The type of the value as stored in storage memory. */
+  virtual ValueType valueType() const { return ValueType(StringValue | ArrayValue); };
+
+  /* The size of the value in bytes as stored in storage memory. */
+  virtual size_t valueSize() const { return N*M; };
+
+  /* Copy the N character arrays of size M into dest. */
+  virtual bool getRaw(void *dest, size_t size) const;
+
+  /* Set the N strings from the character arrays of size M in src. */
+  virtual bool setRaw(const void *src, size_t size);
+
+  /* Return in str the type of the value. */
+  virtual void typeStr(char *str) const;
+
+  /* True if all strings equal their defaults. */
+  virtual bool isDefault() const;
+
+  /* Set all strings back to their defaults. */
+  virtual void resetDefaults();
+
+
+ protected:
+
+  /* Write values to addr in storage memory. */
+  virtual int putValue(int addr, Storage &storage) const;
+
+  /* Read values of size bytes from addr in storage memory. */
+  virtual int getValue(int addr, size_t size, Storage &storage);
+
+  /* Copy vals to the values and notify about the change
+     if they differ. */
+  void changeValues(const char (&vals)[N][M]);
+
+  /* Copy str to item, quoted if needed for a YAML flow sequence. */
+  static void quoteItem(char *item, const char *str);
+
+  /* True if str can be quoted as an item of a YAML flow sequence,
+     i.e. it does not contain both single and double quotes. */
+  static bool quotable(const char *str) {
+    return strchr(str, '"') == NULL || strchr(str, '\'') == NULL; };
+
+  char Values[N][M];
+  const char *Defaults[N];
+
+};
+
+
+template<class T, int N>
+NumberArrayParameter<T, N>::NumberArrayParameter(Menu &menu,
+						 const char *name,
+						 const T (&values)[N],
+						 const char *format,
+						 const char *unit,
+						 const char *outunit,
+						 Action::Modes mode) :
+  BaseNumberParameter<T>(menu, name, format, unit, outunit, 0, 0, mode) {
+  memcpy(Values, values, sizeof(Values));
+  memcpy(Defaults, values, sizeof(Defaults));
+}
+
+
+template<class T, int N>
+NumberArrayParameter<T, N>::NumberArrayParameter(Menu &menu,
+						 const char *name,
+						 const T (&values)[N],
+						 T minimum, T maximum,
+						 const char *format,
+						 const char *unit,
+						 const char *outunit,
+						 Action::Modes mode) :
+  BaseNumberParameter<T>(menu, name, minimum, maximum, format,
+			 unit, outunit, mode) {
+  memcpy(Values, values, sizeof(Values));
+  memcpy(Defaults, values, sizeof(Defaults));
+}
+
+
+template<class T, int N>
+T NumberArrayParameter<T, N>::value(size_t i, const char *unit) const {
+  T val = Values[i];
+  this->toUnit(val, unit);
+  return val;
+}
+
+
+template<class T, int N>
+void NumberArrayParameter<T, N>::setValue(size_t i, T val) {
+  if (i >= N || this->checkMinMax(val) < 0)
+    return;
+  this->changeValue(Values[i], val);
+}
+
+
+template<class T, int N>
+void NumberArrayParameter<T, N>::setValue(size_t i, T val,
+					   const char *unit) {
+  T nv = val;
+  if (!this->fromUnit(nv, unit))
+    return;
+  setValue(i, nv);
+}
+
+
+template<class T, int N>
+bool NumberArrayParameter<T, N>::parseValue(char *val, bool selection) {
+  if (this->disabled(Action::SetValue))
+    return true;
+  if (strlen(val) == 0)
+    return true;
+  // split a copy, so that val is kept for echoing:
+  char str[strlen(val) + 1];
+  strcpy(str, val);
+  char *items[N];
+  if (this->splitList(str, items, N) != N)
+    return false;
+  T vals[N];
+  for (int i=0; i<N; i++) {
+    if (this->SpecialStr != NULL && strlen(this->SpecialStr) > 0 &&
+	strcmp(items[i], this->SpecialStr) == 0) {
+      vals[i] = this->SpecialValue;
+      continue;
+    }
+    if (!this->parseNumber(items[i], vals[i]))
+      return false;
+    if (this->checkMinMax(vals[i]) < 0)
+      return false;
+  }
+  changeValues(vals);
+  return true;
+}
+
+
+template<class T, int N>
+void NumberArrayParameter<T, N>::valueStr(char *str) const {
+  strcpy(str, "[");
+  for (int i=0; i<N; i++) {
+    char s[Parameter::MaxVal];
+    this->formatValue(Values[i], s);
+    if (!this->appendItem(str, s, i > 0))
+      break;
+  }
+  strcat(str, "]");
+}
+
+
+template<class T, int N>
+Parameter::ValueType NumberArrayParameter<T, N>::valueType() const {
+  return Parameter::ValueType(BaseNumberParameter<T>::valueType() |
+			      Parameter::ArrayValue);
+}
+
+
+template<class T, int N>
+void NumberArrayParameter<T, N>::typeStr(char *str) const {
+  BaseNumberParameter<T>::typeStr(str);
+  size_t n = strlen(str);
+  snprintf(str + n, Parameter::MaxType - n, "[%d]", N);
+}
+
+
+template<class T, int N>
+bool NumberArrayParameter<T, N>::getRaw(void *dest, size_t size) const {
+  if (size != sizeof(Values))
+    return false;
+  memcpy(dest, Values, sizeof(Values));
+  return true;
+}
+
+
+template<class T, int N>
+bool NumberArrayParameter<T, N>::setRaw(const void *src, size_t size) {
+  if (size != sizeof(Values) || this->disabled(Action::SetValue))
+    return false;
+  T vals[N];
+  memcpy(vals, src, sizeof(Values));
+  for (int i=0; i<N; i++) {
+    if (this->SpecialStr != NULL && vals[i] == this->SpecialValue)
+      continue;
+    if (this->checkMinMax(vals[i]) < 0)
+      return false;
+  }
+  changeValues(vals);
+  return true;
+}
+
+
+template<class T, int N>
+int NumberArrayParameter<T, N>::putValue(int addr, Storage &storage) const {
+  if (storage.put(addr, Values))
+    return addr += sizeof(Values);
+  else
+    return -1;
+}
+
+
+template<class T, int N>
+int NumberArrayParameter<T, N>::getValue(int addr, size_t size,
+					 Storage &storage) {
+  T vals[N];
+  if (!storage.get(addr, vals))
+    return -1;
+  for (int i=0; i<N; i++) {
+    if (this->CheckMin && vals[i] < this->Minimum)
+      vals[i] = this->Minimum;
+    if (this->CheckMax && vals[i] > this->Maximum)
+      vals[i] = this->Maximum;
+  }
+  changeValues(vals);
+  return addr += sizeof(Values);
+}
+
+
+template<class T, int N>
+size_t NumberArrayParameter<T, N>::writeValue(Stream &stream) const {
+  size_t n = stream.print('[');
+  for (int i=0; i<N; i++) {
+    char s[Parameter::MaxVal];
+    this->formatValue(Values[i], s);
+    if (i > 0)
+      n += stream.print(", ");
+    n += stream.print(s);
+  }
+  n += stream.print(']');
+  return n;
+}
+
+
+template<class T, int N>
+bool NumberArrayParameter<T, N>::isDefault() const {
+  for (int i=0; i<N; i++) {
+    if (Values[i] != Defaults[i])
+      return false;
+  }
+  return true;
+}
+
+
+template<class T, int N>
+void NumberArrayParameter<T, N>::resetDefaults() {
+  if (this->disabled(Action::SetValue))
+    return;
+  changeValues(Defaults);
+}
+
+
+template<class T, int N>
+void NumberArrayParameter<T, N>::changeValues(const T (&vals)[N]) {
+  if (this->setStaged(vals, sizeof(Values)))
+    return;
+  if (memcmp(Values, vals, sizeof(Values)) == 0)
+    return;
+  memcpy(Values, vals, sizeof(Values));
+  this->notifyValue();
+}
+
+
+template<int N, int M>
+StringArrayParameter<N, M>::StringArrayParameter(Menu &menu,
+						 const char *name,
+						 const char *const (&strs)[N],
+						 Action::Modes mode) :
+  Parameter(menu, name, 0, mode) {
+  for (int i=0; i<N; i++) {
+    strncpy(Values[i], strs[i], M);
+    Values[i][M-1] = '\0';
+    Defaults[i] = strs[i];
+  }
+}
+
+
+template<int N, int M>
+bool StringArrayParameter<N, M>::setValue(size_t i, const char *val) {
+  if (disabled(Action::SetValue))
+    return true;
+  if (i >= N || !quotable(val))
+    return false;
+  changeString(Values[i], val, M);
+  return true;
+}
+
+
+template<int N, int M>
+bool StringArrayParameter<N, M>::parseValue(char *val, bool selection) {
+  if (disabled(Action::SetValue))
+    return true;
+  // split a copy, so that val is kept for echoing:
+  char str[strlen(val) + 1];
+  strcpy(str, val);
+  char *items[N];
+  if (splitList(str, items, N) != N)
+    return false;
+  char vals[N][M];
+  for (int i=0; i<N; i++) {
+    if (!quotable(items[i]))
+      return false;
+    strncpy(vals[i], items[i], M);
+    vals[i][M-1] = '\0';
+  }
+  changeValues(vals);
+  return true;
+}
+
+
+template<int N, int M>
+void StringArrayParameter<N, M>::valueStr(char *str) const {
+  strcpy(str, "[");
+  for (int i=0; i<N; i++) {
+    char s[M + 2];
+    quoteItem(s, Values[i]);
+    if (!appendItem(str, s, i > 0))
+      break;
+  }
+  strcat(str, "]");
+}
+
+
+template<int N, int M>
+void StringArrayParameter<N, M>::typeStr(char *str) const {
+  snprintf(str, MaxType, "string %d[%d]", M, N);
+}
+
+
+template<int N, int M>
+bool StringArrayParameter<N, M>::getRaw(void *dest, size_t size) const {
+  if (size != sizeof(Values))
+    return false;
+  memcpy(dest, Values, sizeof(Values));
+  return true;
+}
+
+
+template<int N, int M>
+bool StringArrayParameter<N, M>::setRaw(const void *src, size_t size) {
+  if (size != sizeof(Values) || disabled(Action::SetValue))
+    return false;
+  char vals[N][M];
+  memcpy(vals, src, sizeof(Values));
+  for (int i=0; i<N; i++)
+    vals[i][M-1] = '\0';
+  changeValues(vals);
+  return true;
+}
+
+
+template<int N, int M>
+int StringArrayParameter<N, M>::putValue(int addr, Storage &storage) const {
+  if (storage.put(addr, Values))
+    return addr += sizeof(Values);
+  else
+    return -1;
+}
+
+
+template<int N, int M>
+int StringArrayParameter<N, M>::getValue(int addr, size_t size,
+					 Storage &storage) {
+  char vals[N][M];
+  if (!storage.get(addr, vals))
+    return -1;
+  for (int i=0; i<N; i++)
+    vals[i][M-1] = '\0';
+  changeValues(vals);
+  return addr += sizeof(Values);
+}
+
+
+template<int N, int M>
+size_t StringArrayParameter<N, M>::writeValue(Stream &stream) const {
+  size_t n = stream.print('[');
+  for (int i=0; i<N; i++) {
+    char s[M + 2];
+    quoteItem(s, Values[i]);
+    if (i > 0)
+      n += stream.print(", ");
+    n += stream.print(s);
+  }
+  n += stream.print(']');
+  return n;
+}
+
+
+template<int N, int M>
+bool StringArrayParameter<N, M>::isDefault() const {
+  for (int i=0; i<N; i++) {
+    if (strncmp(Values[i], Defaults[i], M - 1) != 0)
+      return false;
+  }
+  return true;
+}
+
+
+template<int N, int M>
+void StringArrayParameter<N, M>::resetDefaults() {
+  if (disabled(Action::SetValue))
+    return;
+  char vals[N][M];
+  for (int i=0; i<N; i++) {
+    strncpy(vals[i], Defaults[i], M);
+    vals[i][M-1] = '\0';
+  }
+  changeValues(vals);
+}
+
+
+template<int N, int M>
+void StringArrayParameter<N, M>::changeValues(const char (&vals)[N][M]) {
+  if (setStaged(vals, sizeof(Values)))
+    return;
+  bool changed = false;
+  for (int i=0; i<N && !changed; i++)
+    changed = (strcmp(Values[i], vals[i]) != 0);
+  if (!changed)
+    return;
+  memcpy(Values, vals, sizeof(Values));
+  notifyValue();
+}
+
+
+template<int N, int M>
+void StringArrayParameter<N, M>::quoteItem(char *item, const char *str) {
+  size_t n = strlen(str);
+  bool quote = (n == 0 || str[0] == ' ' || str[n-1] == ' ' ||
+		strpbrk(str, ",[]\"'") != NULL);
+  if (!quote) {
+    strcpy(item, str);
+    return;
+  }
+  char q = strchr(str, '"') == NULL ? '"' : '\'';
+  item[0] = q;
+  strcpy(item + 1, str);
+  item[n+1] = q;
+  item[n+2] = '\0';
+}
+
+
+#endif
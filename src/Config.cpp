@@ -10,6 +10,16 @@ Config::Config() :
   Detailed(false),
   GUI(false),
   CurrentMode(User),
+  Migrate(true),
+  CoalesceChanges(true),
+  SaveDefaults(true),
+  Staged(0),
+  ChangeLevel(0),
+  Fingerprint(0),
+  FingerprintValid(false),
+  PresetAddr(0),
+  NPresets(0),
+  PresetSize(0),
   ConfigFile(0),
   SDC(0) {
   ActType = MainMenuType;
@@ -31,6 +41,16 @@ Config::Config(const char *name, unsigned int roles) :
   Detailed(false),
   GUI(false),
   CurrentMode(User),
+  Migrate(true),
+  CoalesceChanges(true),
+  SaveDefaults(true),
+  Staged(0),
+  ChangeLevel(0),
+  Fingerprint(0),
+  FingerprintValid(false),
+  PresetAddr(0),
+  NPresets(0),
+  PresetSize(0),
   ConfigFile(0),
   SDC(0) {
   ActType = MainMenuType;
@@ -48,6 +68,20 @@ void Config::setIdentifier() {
 }
 
 
+void Config::beginChanges() {
+  ChangeLevel++;
+}
+
+
+void Config::endChanges() {
+  if (ChangeLevel <= 0)
+    return;
+  ChangeLevel--;
+  if (ChangeLevel == 0)
+    notifyChanges();
+}
+
+
 const char *Config::configFile() const {
   return ConfigFile;
 }
@@ -72,6 +106,31 @@ void Config::report(Stream &stream) const {
 }
 
 
+void Config::reportDiffs(Stream &stream) const {
+  write(stream, FileOutput | Report | NonDefault);
+}
+
+
+void Config::resetDefaults() {
+  beginChanges();
+  Menu::resetDefaults();
+  endChanges();
+}
+
+
+bool Config::resetDefaults(const char *name, Stream &stream) {
+  Action *act = action(name);
+  if (act == NULL) {
+    stream.printf("ERROR! Parameter \"%s\" not found.\n", name);
+    return false;
+  }
+  beginChanges();
+  act->resetDefaults();
+  endChanges();
+  return true;
+}
+
+
 bool Config::save(Stream &stream, SDClass *sd) const {
   if (sd == NULL)
     sd = SDC;
@@ -90,70 +149,333 @@ bool Config::save(Stream &stream, SDClass *sd) const {
     stream.println("       SD not inserted or SD card full.");
     return false;
   }
-  write(file, FileOutput);
+  write(file, SaveDefaults ? FileOutput : FileOutput | NonDefault);
   file.close();
   return true;
 }
 
 
-void Config::load(Stream &stream, SDClass *sd) {
+bool Config::readTransaction(Stream &instream, Stream &outstream) {
+  size_t n = snapshotSize();
+  uint8_t *staged = (uint8_t *)malloc(n > 0 ? n : 1);
+  if (staged == NULL) {
+    outstream.println("ERROR! Not enough memory for staging the configuration.");
+    return false;
+  }
+  // parse and validate all settings into the staging snapshot:
+  snapshot(staged, n);
+  Staged = staged;
+  size_t errors = read(instream, outstream);
+  Staged = NULL;
+  // set all values at once:
+  if (errors == 0)
+    restore(staged, n);
+  else
+    outstream.printf("%d invalid setting%s, configuration has not been changed.\n",
+		     errors, errors > 1 ? "s" : "");
+  free(staged);
+  return errors == 0;
+}
+
+
+uint8_t *Config::stagedValue(const Action *action) const {
+  if (Staged == NULL)
+    return NULL;
+  int addr = Menu::snapshotAddress(action, 0);
+  return addr < 0 ? NULL : Staged + addr;
+}
+
+
+bool Config::load(Stream &stream, SDClass *sd) {
   if (sd == NULL)
     sd = SDC;
   if (sd == NULL) {
     stream.println("ERROR! No SD card for saving configuration file specified.");
-    return;
+    return false;
   }
   if (configFile() == NULL) {
     stream.println("ERROR! No configuration file name specified.");
-    return;
+    return false;
   }
   File file = sd->open(configFile(), FILE_READ);
-  if (!file || file.available() < 10) {
-    stream.printf("Configuration file \"%s\" not found or empty.\n\n",
+  if (!file) {
+    stream.printf("Configuration file \"%s\" not found.\n\n",
 		  configFile());
-    return;
+    return false;
+  }
+  // files with non-default values only might be empty:
+  if (file.available() == 0) {
+    file.close();
+    stream.printf("Configuration file \"%s\" is empty.\n\n",
+		  configFile());
+    return true;
   }
   stream.printf("Read configuration file \"%s\" ...\n", configFile());
-  read(file, stream);
+  bool r = readTransaction(file, stream);
   file.close();
   stream.println();
+  return r;
 }
 
 
-bool Config::put(Storage &storage, Stream &stream) const {
-  int start_addr = 0;
-  int addr = Menu::put(start_addr, storage, stream);
-  if (addr > start_addr) {
-    uint32_t crc = storage.crc(start_addr, addr);
-    storage.put(addr, crc);
-    return true;
+uint32_t Config::fingerprint() const {
+  if (!FingerprintValid) {
+    Fingerprint = Menu::fingerprint(2166136261UL);
+    FingerprintValid = true;
   }
-  else {
-    if (addr < 0)
-      stream.println("ERROR! Failed to write settings to storage memory.");
+  return Fingerprint;
+}
+
+
+int Config::putRecords(int addr, Storage &storage, Stream &stream) const {
+  uint16_t size = 0;
+  uint32_t fprint = fingerprint();
+  int addr0 = addr + sizeof(size) + sizeof(fprint);
+  int addr1 = Menu::put(addr0, storage, stream);
+  uint32_t end_key = Parameter::EndKey;
+  if (addr1 < addr0 || !storage.put(addr1, end_key))
+    return -1;
+  addr1 += sizeof(end_key);
+  size = addr1 - addr0;
+  if (!storage.put(addr, size) ||
+      !storage.put(addr + sizeof(size), fprint))
+    return -1;
+  uint32_t crc = storage.crc(addr, addr1);
+  if (!storage.put(addr1, crc))
+    return -1;
+  return addr1 + sizeof(crc);
+}
+
+
+bool Config::putImage(int addr, int maxaddr, Storage &storage,
+		      Stream &stream) const {
+  // size of header, records, end marker, and CRC:
+  size_t n = sizeof(uint16_t) + sizeof(uint32_t) + storageSize() +
+    sizeof(Parameter::EndKey) + sizeof(uint32_t);
+  if (addr + n > (size_t)maxaddr) {
+    stream.println("ERROR! Not enough storage memory for settings.");
     return false;
   }
+  // assemble the image in RAM and write it with a single write:
+  uint8_t *buffer = (uint8_t *)malloc(n);
+  int addr1 = -1;
+  if (buffer != NULL) {
+    RAMStorage memory(buffer, n);
+    addr1 = putRecords(0, memory, stream);
+    if (addr1 > 0 && !storage.put(addr, buffer, addr1))
+      addr1 = -1;
+    free(buffer);
+  }
+  else
+    addr1 = putRecords(addr, storage, stream);
+  storage.flush();
+  if (addr1 < 0) {
+    stream.println("ERROR! Failed to write settings to storage memory.");
+    return false;
+  }
+  return true;
+}
+
+
+bool Config::put(Storage &storage, Stream &stream) const {
+  int maxaddr = NPresets > 0 ? PresetAddr : storage.length();
+  return putImage(0, maxaddr, storage, stream);
+}
+
+
+int Config::getRecords(Action *act, int start_addr, Storage &storage,
+		       Stream &stream) {
+  uint16_t size = 0;
+  uint32_t fprint = 0;
+  uint32_t crc_read = 0;
+  // header with size of records and fingerprint of menu structure:
+  size_t nheader = sizeof(size) + sizeof(fprint);
+  if (!storage.get(start_addr, size) || size < sizeof(crc_read) ||
+      start_addr + nheader + size + sizeof(crc_read) > storage.length() ||
+      !storage.get(start_addr + sizeof(size), fprint)) {
+    stream.println("No valid configuration in storage.");
+    return -1;
+  }
+  bool match = (fprint == fingerprint());
+  if (!match && !Migrate) {
+    stream.println("Configuration in storage does not match the menu structure.");
+    return -1;
+  }
+  // read the whole image with a single read into RAM:
+  size_t n = nheader + size + sizeof(crc_read);
+  uint8_t *buffer = (uint8_t *)malloc(n);
+  RAMStorage memory(buffer, n);
+  Storage *image = &storage;
+  int addr = start_addr;
+  if (buffer != NULL && storage.get(start_addr, buffer, n)) {
+    image = &memory;
+    addr = 0;
+  }
+  // check CRC:
+  int addr0 = addr + nheader;
+  int addr1 = addr0 + size;
+  uint32_t crc_data = image->crc(addr, addr1);
+  if (!image->get(addr1, crc_read) || crc_data != crc_read) {
+    free(buffer);
+    stream.println("No valid configuration in storage.");
+    return -1;
+  }
+  // decode:
+  if (act == this) {
+    if (match)
+      stream.println("Read configuration from storage ...");
+    else
+      stream.println("Read configuration of a different menu structure from storage ...");
+  }
+  beginChanges();
+  int r = act->get(addr0, addr1, *image, stream);
+  endChanges();
+  free(buffer);
+  return r < 0 ? -2 : r;
 }
 
 
 bool Config::get(Storage &storage, Stream &stream) {
-  int start_addr = 0;
-  int addr = Menu::get(start_addr, false, storage, stream);
-  if (addr > start_addr) {
-    uint32_t crc_data = storage.crc(start_addr, addr);
-    uint32_t crc_read;
-    storage.get(addr, crc_read);
-    if (crc_data != crc_read) {
-      stream.println("No valid configuration in storage.");
-      return false;
-    }
-    stream.println("Read configuration from storage ...");
-    addr = Menu::get(start_addr, true, storage, stream);
-    if (addr <= start_addr) {
+  int r = getRecords(this, 0, storage, stream);
+  if (r < 0) {
+    if (r < -1)
       stream.println("ERROR! Failed to read settings from storage memory.");
-      return false;
+    return false;
+  }
+  return true;
+}
+
+
+bool Config::get(const char *name, Storage &storage, Stream &stream) {
+  Action *act = action(name);
+  if (act == NULL) {
+    stream.printf("ERROR! Parameter \"%s\" not found.\n", name);
+    return false;
+  }
+  if (getRecords(act, 0, storage, stream) <= 0) {
+    stream.printf("ERROR! Failed to read \"%s\" from storage memory.\n",
+		  name);
+    return false;
+  }
+  return true;
+}
+
+
+bool Config::snapshot(uint8_t *buffer, size_t size) const {
+  if (size < snapshotSize())
+    return false;
+  RAMStorage memory(buffer, size);
+  return Menu::snapshot(0, memory) >= 0;
+}
+
+
+bool Config::restore(const uint8_t *buffer, size_t size) {
+  if (size < snapshotSize())
+    return false;
+  RAMStorage memory(const_cast<uint8_t *>(buffer), size);
+  beginChanges();
+  int r = Menu::restore(0, memory);
+  endChanges();
+  return r >= 0;
+}
+
+
+void Config::setPresets(int addr, size_t n, size_t size) {
+  PresetAddr = addr;
+  NPresets = n;
+  PresetSize = size;
+}
+
+
+bool Config::presetName(size_t index, char *name, Storage &storage) const {
+  name[0] = '\0';
+  if (index >= NPresets ||
+      !storage.get(PresetAddr + index*MaxPreset, name, MaxPreset))
+    return false;
+  name[MaxPreset - 1] = '\0';
+  if (name[0] == '\0' || uint8_t(name[0]) == 0xff) {
+    name[0] = '\0';
+    return false;
+  }
+  return true;
+}
+
+
+int Config::findPreset(const char *name, Storage &storage) const {
+  for (size_t k=0; k<NPresets; k++) {
+    char pname[MaxPreset];
+    if (presetName(k, pname, storage) && strcasecmp(pname, name) == 0)
+      return k;
+  }
+  return -1;
+}
+
+
+size_t Config::listPresets(Storage &storage, Stream &stream) const {
+  size_t n = 0;
+  for (size_t k=0; k<NPresets; k++) {
+    char pname[MaxPreset];
+    if (presetName(k, pname, storage)) {
+      stream.printf("  - %d) %s\n", k+1, pname);
+      n++;
     }
-    return true;
+    else
+      stream.printf("  - %d) -- empty --\n", k+1);
+  }
+  return n;
+}
+
+
+bool Config::putPreset(size_t index, const char *name,
+		       Storage &storage, Stream &stream) const {
+  if (index >= NPresets) {
+    stream.printf("ERROR! Invalid preset slot %d.\n", index+1);
+    return false;
+  }
+  if (name == NULL || strlen(name) == 0) {
+    stream.println("ERROR! No name for preset specified.");
+    return false;
+  }
+  int addr = PresetAddr + NPresets*MaxPreset + index*PresetSize;
+  if (!putImage(addr, addr + PresetSize, storage, stream))
+    return false;
+  char pname[MaxPreset];
+  memset(pname, 0, MaxPreset);
+  strncpy(pname, name, MaxPreset - 1);
+  bool r = storage.put(PresetAddr + index*MaxPreset, pname);
+  storage.flush();
+  if (!r) {
+    stream.println("ERROR! Failed to write preset name to storage memory.");
+    return false;
+  }
+  stream.printf("Wrote configuration to preset \"%s\".\n", pname);
+  return true;
+}
+
+
+bool Config::getPreset(size_t index, Storage &storage, Stream &stream) {
+  char pname[MaxPreset];
+  if (!presetName(index, pname, storage)) {
+    stream.printf("ERROR! No preset in slot %d.\n", index+1);
+    return false;
+  }
+  stream.printf("Read preset \"%s\" from storage.\n", pname);
+  int addr = PresetAddr + NPresets*MaxPreset + index*PresetSize;
+  int r = getRecords(this, addr, storage, stream);
+  if (r < 0) {
+    if (r < -1)
+      stream.println("ERROR! Failed to read settings from storage memory.");
+    return false;
+  }
+  return true;
+}
+
+
+bool Config::getPreset(const char *name, Storage &storage, Stream &stream) {
+  int index = findPreset(name, storage);
+  if (index < 0) {
+    stream.printf("ERROR! Preset \"%s\" not found.\n", name);
+    return false;
   }
-  return false;
+  return getPreset(index, storage, stream);
 }
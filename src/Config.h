@@ -66,6 +66,55 @@ class Config : public Menu {
 
   /* Set current mode of the interactive menu (Admin or User). */
   void setCurrentMode(Modes mode) { CurrentMode = mode; };
+
+  /* Set whether get() should read values from a configuration in
+     storage memory that has been written by a menu with a different
+     structure (default). If false, such configurations are rejected
+     right after reading the header. */
+  void setMigrate(bool migrate) { Migrate = migrate; };
+
+  /* Set whether callbacks registered via setOnChange() should be
+     called only once after bulk operations like load(), get(), or
+     getPreset() (default), or on each individual change. */
+  void setCoalesceChanges(bool coalesce) { CoalesceChanges = coalesce; };
+
+  /* Set whether save() writes all values (default) or only the
+     values differing from their defaults. */
+  void setSaveDefaults(bool save) { SaveDefaults = save; };
+
+  /* Start a bulk operation. Until the matching endChanges(),
+     changes are only marked if coalescing is enabled.
+     Calls can be nested. */
+  void beginChanges();
+
+  /* End a bulk operation. After the outermost one,
+     the callbacks of all changed actions are called. */
+  void endChanges();
+
+  /* True if changes are marked only and their callbacks are deferred
+     to endChanges(). */
+  bool deferChanges() const { return CoalesceChanges && ChangeLevel > 0; };
+
+  /* True while readTransaction() validates the configuration settings.
+     Parsed values are then written into the staging snapshot only,
+     and only invalid values are reported. */
+  bool staging() const { return Staged != NULL; };
+
+  /* The staged value of action within the staging snapshot while
+     readTransaction() validates the configuration settings,
+     NULL otherwise. */
+  uint8_t *stagedValue(const Action *action) const;
+
+  using Menu::fingerprint;
+
+  /* Fingerprint of the keys, types and sizes of all parameters
+     that are written to storage memory by put().
+     Computed once and cached until invalidateFingerprint() is called. */
+  uint32_t fingerprint() const;
+
+  /* Recompute the fingerprint() on its next use.
+     Called whenever actions are added, renamed, or their roles change. */
+  void invalidateFingerprint() { FingerprintValid = false; };
   
   /* Interactive menu via serial stream.
      Output a line of ":" in front. */
@@ -75,41 +124,182 @@ class Config : public Menu {
      (all actions with FileOutput and Report roles). */
   void report(Stream &stream=Serial) const;
 
+  /* Report only the values of the configuration menu that differ
+     from their defaults on stream
+     (all actions with FileOutput and Report roles). */
+  void reportDiffs(Stream &stream=Serial) const;
+
+  /* Set the values of all parameters back to their defaults.
+     Callbacks are called once at the end. */
+  void resetDefaults();
+
+  /* Set the value of the parameter, or all values of the menu,
+     matching name back to their defaults.
+     Callbacks are called once at the end.
+     Report errors on stream.
+     Return false if name was not found. */
+  bool resetDefaults(const char *name, Stream &stream=Serial);
+
   /* Save current setting to configuration file on SD card
      using the role FileOutput for the report() function.
+     If setSaveDefaults() was set to false, only values differing
+     from their defaults are written.
      Report errors and success on stream.
      Return true on success.
      If sd is NULL write to default SD card provided via setConfigFile(). */
   bool save(Stream &stream=Serial, SDClass *sd=0) const;
 
+  /* Read configuration settings from instream in two phases.
+     First, all settings are parsed and validated into a staging
+     snapshot, without changing the configuration. Then, only if all
+     settings were valid, the values are set all at once from the
+     staging snapshot. Callbacks are called once at the end.
+     Needs snapshotSize() bytes of heap memory.
+     Unknown sections and keys are reported and skipped, they do
+     not fail the transaction.
+     Report errors on outstream.
+     Return true if all settings were valid and have been set. */
+  bool readTransaction(Stream &instream=Serial, Stream &outstream=Serial);
+
   /* Read configuration file from SD card and configure all actions
-     accordingly.
+     accordingly via readTransaction(). If the file contains invalid
+     settings, the configuration is not changed at all. An empty file,
+     as saved with setSaveDefaults(false) when all values are at their
+     defaults, is valid and does not change anything either.
      Report errors and success on stream.
-     If sd is NULL read from default SD card provided via setConfigFile(). */
-  void load(Stream &stream=Serial, SDClass *sd=0);
+     If sd is NULL read from default SD card provided via setConfigFile().
+     Return true on success. */
+  bool load(Stream &stream=Serial, SDClass *sd=0);
 
   using Menu::put;
   using Menu::get;
 
   /* Write configuration with role StoragePut to storage memory.
+     A header with the size of all records and the fingerprint()
+     is followed by the records. Each parameter
+     is stored as a record with its key, type, size, and value.
+     The records are followed by an end marker and a CRC.
      Report errors and success on stream.
      Return true on success. */
   bool put(Storage &storage=EEPROMStorage, Stream &stream=Serial) const;
   
   /* Read configuration with role StorageGet from storage memory.
+     The stored records are read at once into a buffer in RAM,
+     from which the CRC is computed and the values are read.
+     Parameters are matched to the stored records via their keys.
+     Parameters without a matching record keep their values and
+     records without matching parameter are skipped.
      Report errors and success on stream.
      Return true on success. */
   bool get(Storage &storage=EEPROMStorage, Stream &stream=Serial);
+  
+  /* Read only the value of the parameter, or all values of the menu,
+     matching name from storage memory.
+     Report errors and success on stream.
+     Return true on success. */
+  bool get(const char *name, Storage &storage=EEPROMStorage,
+	   Stream &stream=Serial);
+
+  using Menu::snapshot;
+  using Menu::restore;
+
+  /* Copy the values of all parameters in their binary representation,
+     as written by put() but without keys, types, and sizes, into
+     buffer of size bytes. The buffer needs to hold at least
+     snapshotSize() bytes.
+     Return false if the buffer is too small. */
+  bool snapshot(uint8_t *buffer, size_t size) const;
+
+  /* Set the values of all parameters from buffer of size bytes
+     previously filled by snapshot().
+     Callbacks are called once at the end.
+     Return false if the buffer is smaller than snapshotSize(). */
+  bool restore(const uint8_t *buffer, size_t size);
+
+  /* Reserve n preset slots of size bytes each in storage memory
+     starting at addr. The slots are preceded by a directory with
+     the names of the presets. put() is then restricted to the
+     storage memory below addr. */
+  void setPresets(int addr, size_t n, size_t size);
+
+  /* Number of preset slots. */
+  size_t presets() const { return NPresets; };
+
+  /* Maximum size of preset names including the terminating zero. */
+  static const size_t MaxPreset = 16;
+
+  /* Return in name (of size MaxPreset) the name of the preset in
+     slot index. Return false if the slot is empty. */
+  bool presetName(size_t index, char *name,
+		  Storage &storage=EEPROMStorage) const;
+
+  /* Return the index of the preset slot with name,
+     -1 if there is no such preset. */
+  int findPreset(const char *name, Storage &storage=EEPROMStorage) const;
+
+  /* List the names of all preset slots on stream.
+     Return the number of used slots. */
+  size_t listPresets(Storage &storage=EEPROMStorage,
+		     Stream &stream=Serial) const;
+
+  /* Write configuration with role StoragePut under name
+     into preset slot index.
+     Report errors and success on stream.
+     Return true on success. */
+  bool putPreset(size_t index, const char *name,
+		 Storage &storage=EEPROMStorage, Stream &stream=Serial) const;
+
+  /* Read configuration with role StorageGet from preset slot index.
+     Report errors and success on stream.
+     Return true on success. */
+  bool getPreset(size_t index, Storage &storage=EEPROMStorage,
+		 Stream &stream=Serial);
+
+  /* Read configuration with role StorageGet from preset with name.
+     Report errors and success on stream.
+     Return true on success. */
+  bool getPreset(const char *name, Storage &storage=EEPROMStorage,
+		 Stream &stream=Serial);
 
 
 protected:
 
+  /* Write header, records, end marker and CRC to addr in storage memory.
+     Return address behind the CRC, -1 on error. */
+  int putRecords(int addr, Storage &storage, Stream &stream) const;
+
+  /* Assemble header, records, end marker and CRC in a buffer and write
+     it with a single write to addr in storage memory.
+     The written data must not exceed maxaddr.
+     Report errors on stream.
+     Return true on success. */
+  bool putImage(int addr, int maxaddr, Storage &storage,
+		Stream &stream) const;
+
+  /* Read the records stored at addr in storage memory with a single read
+     into a buffer, check the CRC, and let act get its values from the
+     buffer.
+     Return the number of values read, -1 if there is no valid
+     configuration in storage, -2 on error. */
+  int getRecords(Action *act, int addr, Storage &storage, Stream &stream);
+
   size_t Indentation;
   unsigned long TimeOut;
   bool Echo;
   bool Detailed;
   bool GUI;
   Modes CurrentMode;
+  bool Migrate;
+  bool CoalesceChanges;
+  bool SaveDefaults;
+  uint8_t *Staged;
+  int ChangeLevel;
+  mutable uint32_t Fingerprint;
+  mutable bool FingerprintValid;
+
+  int PresetAddr;
+  size_t NPresets;
+  size_t PresetSize;
   
   const char *ConfigFile;
   SDClass *SDC;
@@ -21,7 +21,17 @@ void ReadConfigAction::execute(Stream &stream) {
     yield();
     delay(1);
   }
-  root()->read(stream, stream);
+  root()->readTransaction(stream, stream);
+  stream.println();
+}
+
+
+void ResetConfigAction::execute(Stream &stream) {
+  if (Action::yesno("Do you really want to reset the configuration to its defaults?",
+		    false, echo(), stream)) {
+    root()->resetDefaults();
+    stream.println("\nReset configuration to defaults.");
+  }
   stream.println();
 }
 
@@ -114,25 +124,90 @@ void GetConfigAction::execute(Stream &stream) {
 }
 
 
+// Let the user select one of the n preset slots.
+// Return index of selected slot or -1 if aborted.
+static int select_preset(size_t n, bool echo, Stream &stream) {
+  while (true) {
+    stream.print("Select a preset [1]: ");
+    while (stream.available() == 0)
+      yield();
+    char pval[32];
+    stream.readBytesUntil('\n', pval, 32);
+    if (strlen(pval) == 0)
+      strcpy(pval, "1");
+    if (echo)
+      stream.println(pval);
+    char *end;
+    long i = strtol(pval, &end, 10) - 1;
+    if (end != pval && i >= 0 && i < (long)n)
+      return i;
+    else if (strcmp(pval, "q") == 0)
+      return -1;
+  }
+}
+
+
+void PutPresetAction::execute(Stream &stream) {
+  stream.println("Preset slots:");
+  root()->listPresets(Store, stream);
+  stream.println();
+  int index = select_preset(root()->presets(), echo(), stream);
+  stream.println();
+  if (index < 0)
+    return;
+  char name[Config::MaxPreset];
+  if (root()->presetName(index, name, Store))
+    stream.printf("Overwriting preset \"%s\".\n", name);
+  while (true) {
+    stream.print("Enter name of the preset: ");
+    while (stream.available() == 0)
+      yield();
+    stream.readBytesUntil('\n', name, Config::MaxPreset);
+    if (echo())
+      stream.println(name);
+    if (strlen(name) > 0)
+      break;
+  }
+  root()->putPreset(index, name, Store, stream);
+  stream.println();
+}
+
+
+void GetPresetAction::execute(Stream &stream) {
+  stream.println("Presets:");
+  if (root()->listPresets(Store, stream) == 0) {
+    stream.println("No presets stored.\n");
+    return;
+  }
+  stream.println();
+  int index = select_preset(root()->presets(), echo(), stream);
+  stream.println();
+  if (index >= 0)
+    root()->getPreset(index, Store, stream);
+  stream.println();
+}
+
+
 void StorageClearAction::execute(Stream &stream) {
   if (Action::yesno("Do you really want to clear the full EEPROM memory?", false, echo(), stream)) {
     uint8_t buffer[64];
     memset(buffer, 0xff, 64);
-    for (unsigned int i=0; i < Store.length(); i+=64)
-      Store.put(i, buffer);
-    stream.printf("Wrote 0xFF to all %u EEPROM memory cells.\n",
-		  Store.length());
+    for (uint32_t i=0; i < Store.length(); i+=64)
+      Store.put(i, buffer, Store.length() - i < 64 ? Store.length() - i : 64);
+    Store.flush();
+    stream.printf("Wrote 0xFF to all %lu EEPROM memory cells.\n",
+		  (unsigned long)Store.length());
     stream.println();
   }
 }
 
 
 void StorageHexdumpAction::execute(Stream &stream) {
-  unsigned int i=0;
+  uint32_t i=0;
   while (i < Store.length()) {
-    stream.printf("%04x  ", i);
+    stream.printf("%04lx  ", (unsigned long)i);
     uint8_t buffer[16];
-    Store.get(i, buffer);
+    Store.get(i, buffer, Store.length() - i < 16 ? Store.length() - i : 16);
     for (unsigned int j=0; j < 2; j++) {
       for (unsigned int k=0; k < 8; k++) {
 	if (i + 8*j + k < Store.length())
@@ -163,10 +238,26 @@ ConfigurationMenu::ConfigurationMenu(Menu &menu, SDClass &sd,
   SaveAct(*this,"Save configuration file", sd),
   LoadAct(*this, "Load configuration file", sd),
   RemoveAct(*this, "Erase configuration file", sd),
+  ResetAct(*this, "Reset configuration to defaults"),
   PutAct(*this,"Put configuration to EEPROM", storage),
   GetAct(*this, "Get configuration from EEPROM", storage),
+  PutPresetAct(*this, "Put preset to EEPROM", storage),
+  GetPresetAct(*this, "Get preset from EEPROM", storage),
   ClearAct(*this, "Clear EEPROM memory", storage),
   HexdumpAct(*this, "EEPROM memory content", storage),
   ReadAct(*this, "Read configuration from stream") {
 }
 
+
+
+void ConfigurationMenu::execute(Stream &stream) {
+  if (root()->presets() > 0) {
+    PutPresetAct.enable(StreamInput);
+    GetPresetAct.enable(StreamInput);
+  }
+  else {
+    PutPresetAct.disable(StreamInput);
+    GetPresetAct.disable(StreamInput);
+  }
+  Menu::execute(stream);
+}
@@ -36,6 +36,17 @@ class ReadConfigAction : public ReportConfigAction {
 };
 
 
+class ResetConfigAction : public ReportConfigAction {
+
+ public:
+  
+  using ReportConfigAction::ReportConfigAction;
+
+  /* Set all configuration settings back to their defaults. */
+  virtual void execute(Stream &stream=Serial);
+};
+
+
 class SDClassAction : public Action {
 
  public:
@@ -117,6 +128,28 @@ class GetConfigAction : public StorageAction {
 };
 
 
+class PutPresetAction : public StorageAction {
+
+ public:
+  
+  using StorageAction::StorageAction;
+
+  /* Write configuration settings to a named preset slot in storage. */
+  virtual void execute(Stream &stream=Serial);
+};
+
+
+class GetPresetAction : public StorageAction {
+
+ public:
+  
+  using StorageAction::StorageAction;
+
+  /* Select a preset and read its configuration settings from storage. */
+  virtual void execute(Stream &stream=Serial);
+};
+
+
 class StorageClearAction : public StorageAction {
 
  public:
@@ -145,12 +178,19 @@ public:
 
   ConfigurationMenu(Menu &menu, SDClass &sd, Storage &storage=EEPROMStorage);
 
+  /* Interactive menu via serial stream.
+     The preset actions are only shown if the root menu has preset slots. */
+  virtual void execute(Stream &stream=Serial);
+
   ReportConfigAction ReportAct;
   SaveConfigAction SaveAct;
   LoadConfigAction LoadAct;
   RemoveConfigAction RemoveAct;
+  ResetConfigAction ResetAct;
   PutConfigAction PutAct;
   GetConfigAction GetAct;
+  PutPresetAction PutPresetAct;
+  GetPresetAction GetPresetAct;
   StorageClearAction ClearAct;
   StorageHexdumpAction HexdumpAct;
   ReadConfigAction ReadAct;
@@ -0,0 +1,72 @@
+#include <FileStorage.h>
+
+
+FileStorage::FileStorage(SDClass &sd, const char *fname, uint32_t size) :
+  SDC(sd),
+  FileName(fname),
+  Size(size) {
+}
+
+
+FileStorage::~FileStorage() {
+  close();
+}
+
+
+bool FileStorage::open() {
+  if (DataFile)
+    return true;
+  DataFile = SDC.open(FileName, FILE_WRITE);
+  if (!DataFile)
+    return false;
+  // preallocate file with erased memory:
+  uint32_t n = DataFile.size();
+  if (n < Size) {
+    uint8_t buffer[64];
+    memset(buffer, 0xff, sizeof(buffer));
+    DataFile.seek(n);
+    while (n < Size) {
+      size_t m = Size - n < sizeof(buffer) ? Size - n : sizeof(buffer);
+      if (DataFile.write(buffer, m) != m) {
+	DataFile.close();
+	return false;
+      }
+      n += m;
+    }
+    DataFile.flush();
+  }
+  return true;
+}
+
+
+void FileStorage::close() {
+  if (DataFile) {
+    DataFile.flush();
+    DataFile.close();
+  }
+}
+
+
+void FileStorage::flush() {
+  if (DataFile)
+    DataFile.flush();
+}
+
+
+uint32_t FileStorage::length() {
+  return Size;
+}
+
+
+int FileStorage::read(unsigned int idx, uint8_t *dest, size_t len) {
+  if (idx + len > Size || !open() || !DataFile.seek(idx))
+    return -1;
+  return DataFile.read(dest, len);
+}
+
+  
+int FileStorage::update(unsigned int idx, const uint8_t *src, size_t len) {
+  if (idx + len > Size || !open() || !DataFile.seek(idx))
+    return -1;
+  return DataFile.write(src, len);
+}
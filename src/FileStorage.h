@@ -0,0 +1,63 @@
+/*
+  FileStorage - Storage in a preallocated file on SD card.
+
+  Maps the linear addresses of the Storage interface onto a file of
+  fixed size. On first use, the file is created and filled up with
+  0xFF, like erased EEPROM. Data are read and written in blocks,
+  making it a Storage for configurations much larger than the
+  internal EEPROM.
+*/
+
+#ifndef FileStorage_h
+#define FileStorage_h
+
+
+#include <SD.h>
+#include <Storage.h>
+
+
+class FileStorage : public Storage {
+
+ public:
+
+  // Constructor for storage of size bytes in file fname on SD card sd.
+  // Only the pointer to fname is stored.
+  FileStorage(SDClass &sd, const char *fname, uint32_t size);
+
+  // Destructor. Closes the file.
+  virtual ~FileStorage();
+
+  // Open the file and extend it to its size, if necessary.
+  // Called automatically by the first read or write.
+  // Return true on success.
+  bool open();
+
+  // Flush and close the file.
+  void close();
+
+  // Write buffered data to the file.
+  virtual void flush();
+
+  // Size of storage in bytes.
+  virtual uint32_t length();
+
+
+protected:
+
+  // Read len bytes from file at idx into buffer at address dest.
+  // Return number of bytes actually read, negative number on error.
+  virtual int read(unsigned int idx, uint8_t *dest, size_t len);
+  
+  // Write a len bytes from buffer at address src to file at idx.
+  // Return number of bytes actually written, negative number on error..
+  virtual int update(unsigned int idx, const uint8_t *src, size_t len);
+
+  SDClass &SDC;
+  const char *FileName;
+  uint32_t Size;
+  File DataFile;
+
+};
+
+
+#endif
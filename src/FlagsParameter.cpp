@@ -0,0 +1,279 @@
+#include <Config.h>
+#include <FlagsParameter.h>
+
+
+BaseFlagsParameter::BaseFlagsParameter(Menu &menu, const char *name,
+				       uint32_t *value,
+				       const char *const *names, size_t n,
+				       Modes mode) :
+  Parameter(menu, name, 0, mode),
+  Value(value),
+  Default(0),
+  Names(names),
+  NFlags(n < MaxFlags ? n : MaxFlags) {
+}
+
+
+static uint32_t flags_mask(size_t n) {
+  return n >= 32 ? 0xffffffffUL : (1UL << n) - 1;
+}
+
+
+int BaseFlagsParameter::flagIndex(const char *name) const {
+  for (size_t i=0; i<NFlags; i++) {
+    if (strcasecmp(Names[i], name) == 0)
+      return i;
+  }
+  return -1;
+}
+
+
+bool BaseFlagsParameter::flag(const char *name) const {
+  int i = flagIndex(name);
+  return i >= 0 && flag(i);
+}
+
+
+bool BaseFlagsParameter::setFlag(size_t i, bool on) {
+  if (disabled(SetValue))
+    return true;
+  if (i >= NFlags)
+    return false;
+  uint32_t flags = *Value;
+  getStaged(&flags, sizeof(flags));
+  if (on)
+    flags |= 1UL << i;
+  else
+    flags &= ~(1UL << i);
+  changeValue(*Value, flags);
+  return true;
+}
+
+
+bool BaseFlagsParameter::setFlag(const char *name, bool on) {
+  int i = flagIndex(name);
+  if (i < 0)
+    return false;
+  return setFlag(i, on);
+}
+
+
+bool BaseFlagsParameter::setValue(uint32_t flags) {
+  if (disabled(SetValue))
+    return true;
+  if ((flags & ~flags_mask(NFlags)) != 0)
+    return false;
+  changeValue(*Value, flags);
+  return true;
+}
+
+
+void BaseFlagsParameter::resetDefaults() {
+  if (disabled(SetValue))
+    return;
+  changeValue(*Value, Default);
+}
+
+
+void BaseFlagsParameter::writeEntry(Stream &stream, size_t width) const {
+  stream.printf("%s ...\n", name());
+}
+
+
+void BaseFlagsParameter::write(Stream &stream, unsigned int roles,
+			       size_t indent, size_t width) const {
+  if (disabled(roles))
+    return;
+  // flags to be written:
+  uint32_t mask = flags_mask(NFlags);
+  if ((roles & NonDefault) > 0)
+    mask &= *Value ^ Default;
+  if (mask == 0)
+    return;
+  size_t ww = 0;
+  for (size_t i=0; i<NFlags; i++) {
+    if ((mask & (1UL << i)) && strlen(Names[i]) > ww)
+      ww = strlen(Names[i]);
+  }
+  stream.printf("%*s%s:\n", indent, "", name());
+  indent += indentation();
+  for (size_t i=0; i<NFlags; i++) {
+    if (mask & (1UL << i))
+      stream.printf("%*s%s:%*s %s\n", indent, "", Names[i],
+		    ww - strlen(Names[i]), "", flag(i) ? "yes" : "no");
+  }
+}
+
+
+void BaseFlagsParameter::execute(Stream &stream) {
+  if (disabled(StreamIO))
+    return;
+  if (disabled(SetValue)) {
+    write(stream, StreamIO);
+    stream.println();
+    return;
+  }
+  size_t width = 0;
+  for (size_t i=0; i<NFlags; i++) {
+    if (strlen(Names[i]) > width)
+      width = strlen(Names[i]);
+  }
+  size_t wd = NFlags >= 10 ? 2 : 1;
+  while (true) {
+    stream.printf("%s:\n", name());
+    for (size_t i=0; i<NFlags; i++)
+      stream.printf("%*s%*d) %s:%*s %s\n", indentation(), "", wd, i + 1,
+		    Names[i], width - strlen(Names[i]), "",
+		    flag(i) ? "yes" : "no");
+    stream.print("Select flag to toggle (q to quit): ");
+    while (stream.available() == 0) {
+      yield();
+      delay(1);
+    }
+    char pval[32];
+    stream.readBytesUntil('\n', pval, 32);
+    if (echo())
+      stream.println(pval);
+    if (strlen(pval) == 0 || strcmp(pval, "q") == 0)
+      break;
+    char *end;
+    long i = strtol(pval, &end, 10) - 1;
+    if (end != pval && i >= 0 && i < (long)NFlags)
+      setFlag(i, !flag(i));
+    stream.println();
+  }
+  stream.println();
+}
+
+
+bool BaseFlagsParameter::set(const char *val, const char *name,
+			     Stream &stream) {
+  int i = name != 0 ? flagIndex(name) : -1;
+  if (i < 0)
+    return Parameter::set(val, name, stream);
+  char keyname[strlen(this->name()) + strlen(Names[i]) + 2];
+  strcpy(keyname, this->name());
+  strcat(keyname, ">");
+  strcat(keyname, Names[i]);
+  if (disabled(SetValue)) {
+    if (enabled(StreamOutput))
+      stream.printf("%*ssetting a new value for %s is disabled\n",
+		    indentation(), "", keyname);
+    return true;
+  }
+  bool on;
+  bool r = parseFlag(val, on) && setFlag(i, on);
+  if (disabled(StreamOutput))
+    return r;
+  if (r) {
+    if (Root == NULL || !Root->staging())
+      stream.printf("%*sset %-25s to %s\n", indentation(), "", keyname,
+		    flag(i) ? "yes" : "no");
+  }
+  else
+    stream.printf("%*s%s is not a valid value for %s\n",
+		  indentation(), "", val, keyname);
+  return r;
+}
+
+
+bool BaseFlagsParameter::parseValue(char *val, bool selection) {
+  if (disabled(SetValue))
+    return true;
+  // split a copy, so that val is kept for echoing:
+  char str[strlen(val) + 1];
+  strcpy(str, val);
+  char *items[MaxFlags];
+  int n = splitList(str, items, MaxFlags);
+  if (n < 0)
+    return false;
+  uint32_t flags = 0;
+  for (int k=0; k<n; k++) {
+    int i = flagIndex(items[k]);
+    if (i < 0)
+      return false;
+    flags |= 1UL << i;
+  }
+  changeValue(*Value, flags);
+  return true;
+}
+
+
+void BaseFlagsParameter::valueStr(char *str) const {
+  strcpy(str, "[");
+  bool separate = false;
+  for (size_t i=0; i<NFlags; i++) {
+    if (!flag(i))
+      continue;
+    if (!appendItem(str, Names[i], separate))
+      break;
+    separate = true;
+  }
+  strcat(str, "]");
+}
+
+
+size_t BaseFlagsParameter::writeValue(Stream &stream) const {
+  size_t n = stream.print('[');
+  bool separate = false;
+  for (size_t i=0; i<NFlags; i++) {
+    if (!flag(i))
+      continue;
+    if (separate)
+      n += stream.print(", ");
+    n += stream.print(Names[i]);
+    separate = true;
+  }
+  n += stream.print(']');
+  return n;
+}
+
+
+bool BaseFlagsParameter::getRaw(void *dest, size_t size) const {
+  if (size != sizeof(uint32_t))
+    return false;
+  memcpy(dest, Value, sizeof(uint32_t));
+  return true;
+}
+
+
+bool BaseFlagsParameter::setRaw(const void *src, size_t size) {
+  if (size != sizeof(uint32_t) || disabled(SetValue))
+    return false;
+  uint32_t flags;
+  memcpy(&flags, src, sizeof(uint32_t));
+  return setValue(flags);
+}
+
+
+void BaseFlagsParameter::typeStr(char *str) const {
+  snprintf(str, MaxType, "flags %d", NFlags);
+}
+
+
+int BaseFlagsParameter::putValue(int addr, Storage &storage) const {
+  if (storage.put(addr, *Value))
+    return addr += sizeof(uint32_t);
+  else
+    return -1;
+}
+
+
+int BaseFlagsParameter::getValue(int addr, size_t size, Storage &storage) {
+  uint32_t flags;
+  if (!storage.get(addr, flags))
+    return -1;
+  changeValue(*Value, flags & flags_mask(NFlags));
+  return addr += sizeof(uint32_t);
+}
+
+
+bool BaseFlagsParameter::parseFlag(const char *val, bool &on) {
+  if (strcasecmp(val, "yes") == 0)
+    on = true;
+  else if (strcasecmp(val, "no") == 0)
+    on = false;
+  else
+    return false;
+  return true;
+}
@@ -0,0 +1,214 @@
+/*
+  FlagsParameter - Groups of up to 32 boolean flags packed into a single word.
+
+  Each BoolParameter is a complete parameter with its own menu entry
+  and storage record. Many on/off feature flags are therefore better
+  bundled into a single flags parameter that stores up to 32 booleans
+  as bits of a single uint32_t word. Only pointers to the names of the
+  flags are stored, so pass an array of literal strings.
+
+  In the interactive menu, the group is shown as a submenu, where each
+  flag is listed as a yes/no entry that is toggled by selecting it. In
+  configuration files, the group is written as a section with one
+  "name: yes/no" line per flag, like a menu. Everywhere else, like
+  in put() and get(), the value of the group is the list of names of
+  the set flags, like "[logging, led]". In storage memory and over the
+  bus the group is a single uint32_t word, with flag i in bit i.
+
+  Classes:
+
+  - BaseFlagsParameter: Base class for a group of boolean flags.
+  - FlagsParameter: A group of boolean flags.
+  - FlagsPointerParameter: A group of boolean flags stored in an external word.
+*/
+
+#ifndef FlagsParameter_h
+#define FlagsParameter_h
+
+
+#include <Parameter.h>
+
+
+/* Base class for a group of boolean flags. */
+class BaseFlagsParameter : public Parameter {
+
+ public:
+
+  /* Maximum number of flags in a group. */
+  static const size_t MaxFlags = 32;
+
+  /* Initialize parameter with identifying name, pointer to the word
+     holding the flags, and the names of n flags, and add it to menu. */
+  BaseFlagsParameter(Menu &menu, const char *name, uint32_t *value,
+		     const char *const *names, size_t n, Modes mode);
+
+  /* Number of flags. */
+  size_t size() const { return NFlags; };
+
+  /* Name of the i-th flag. */
+  const char *flagName(size_t i) const { return Names[i]; };
+
+  /* Index of the flag with name (case insensitive),
+     -1 if there is no such flag. */
+  int flagIndex(const char *name) const;
+
+  /* Return the i-th flag. */
+  bool flag(size_t i) const { return i < NFlags && (*Value & (1UL << i)); };
+
+  /* Return the flag with name, false if there is no such flag. */
+  bool flag(const char *name) const;
+
+  /* Set the i-th flag to on.
+     Return true if the flag was set or the parameter was disabled. */
+  bool setFlag(size_t i, bool on);
+
+  /* Set the flag with name to on.
+     Return true if the flag was set or the parameter was disabled. */
+  bool setFlag(const char *name, bool on);
+
+  /* Return all flags, flag i in bit i. */
+  uint32_t value() const { return *Value; };
+
+  /* Set all flags at once, flag i in bit i.
+     Return false if bits beyond the number of flags are set. */
+  bool setValue(uint32_t flags);
+
+  /* Write the group as a submenu entry for display in a menu. */
+  virtual void writeEntry(Stream &stream=Serial, size_t width=0) const;
+
+  /* Write the name of the group followed by the indented flags
+     with their yes/no values to stream. If roles contains NonDefault,
+     only the flags differing from their defaults are written. */
+  virtual void write(Stream &stream=Serial, unsigned int roles=AllRoles,
+		     size_t indent=0, size_t width=0) const;
+
+  /* Interactive configuration via serial stream.
+     List the flags and toggle the selected ones. */
+  virtual void execute(Stream &stream=Serial);
+
+  /* If name is the name of a flag, parse "yes" or "no" from val and
+     set this flag accordingly (this is how the lines of a
+     configuration file are passed on). Otherwise parse val as the list
+     of names of the set flags. If StreamOutput is enabled, report the
+     new value on stream.
+     Return false if val was not valid. */
+  virtual bool set(const char *val, const char *name=0,
+		   Stream &stream=Serial);
+
+  /* True if name is the name of a flag. */
+  virtual bool hasKey(const char *name) const { return flagIndex(name) >= 0; };
+
+  /* Parse the YAML flow sequence of flag names in val,
+     set the listed flags and clear all others.
+     Return true if all names were valid or the parameter was disabled. */
+  virtual bool parseValue(char *val, bool selection=false);
+
+  /* Return the names of the set flags as a YAML flow sequence. */
+  virtual void valueStr(char *str) const;
+
+  /* Write the names of the set flags to stream. */
+  virtual size_t writeValue(Stream &stream) const;
+
+  /* The type of the value as stored in storage memory. */
+  virtual ValueType valueType() const { return UnsignedValue; };
+
+  /* The size of the value in bytes as stored in storage memory. */
+  virtual size_t valueSize() const { return sizeof(uint32_t); };
+
+  /* Copy the word holding the flags into dest. */
+  virtual bool getRaw(void *dest, size_t size) const;
+
+  /* Set all flags from the word in src. */
+  virtual bool setRaw(const void *src, size_t size);
+
+  /* Return in str the type of the value. */
+  virtual void typeStr(char *str) const;
+
+  /* The flags the parameter was initialized with. */
+  uint32_t defaultValue() const { return Default; };
+
+  /* True if all flags equal their defaults. */
+  virtual bool isDefault() const { return *Value == Default; };
+
+  /* Set all flags back to their defaults. */
+  virtual void resetDefaults();
+
+
+ protected:
+
+  /* Write the word holding the flags to addr in storage memory. */
+  virtual int putValue(int addr, Storage &storage) const;
+
+  /* Read the word holding the flags from addr in storage memory. */
+  virtual int getValue(int addr, size_t size, Storage &storage);
+
+  /* Parse "yes" or "no" from val into on.
+     Return false if val is neither. */
+  static bool parseFlag(const char *val, bool &on);
+
+  uint32_t *Value;
+  uint32_t Default;
+  const char *const *Names;
+  uint8_t NFlags;
+
+};
+
+
+/* A group of boolean flags. */
+class FlagsParameter : public BaseFlagsParameter {
+
+ public:
+
+  /* Initialize parameter with identifying name, the names of N flags,
+     and the initial flags (flag i in bit i), and add it to menu. */
+  template<int N>
+  FlagsParameter(Menu &menu, const char *name,
+		 const char *const (&names)[N], uint32_t flags=0,
+		 Modes mode=User) :
+    BaseFlagsParameter(menu, name, &Flags, names, N, mode),
+    Flags(flags) {
+    static_assert(N <= (int)MaxFlags, "at most 32 flags per group");
+    Default = flags;
+  };
+
+
+ protected:
+
+  uint32_t Flags;
+
+};
+
+
+/* A group of boolean flags stored in an external word. */
+class FlagsPointerParameter : public BaseFlagsParameter {
+
+ public:
+
+  /* Initialize parameter with identifying name, pointer to the word
+     holding the flags (flag i in bit i), and the names of N flags,
+     and add it to menu. */
+  template<int N>
+  FlagsPointerParameter(Menu &menu, const char *name, uint32_t *flags,
+			const char *const (&names)[N], Modes mode=User) :
+    BaseFlagsParameter(menu, name, flags, names, N, mode) {
+    static_assert(N <= (int)MaxFlags, "at most 32 flags per group");
+    Default = *flags;
+  };
+
+  /* Initialize parameter with identifying name, pointer to a shared
+     word holding the flags (flag i in bit i), and the names of N flags,
+     and add it to menu. */
+  template<int N>
+  FlagsPointerParameter(Menu &menu, const char *name,
+			Shared<uint32_t> *flags,
+			const char *const (&names)[N], Modes mode=User) :
+    BaseFlagsParameter(menu, name, flags->shadow(), names, N, mode) {
+    static_assert(N <= (int)MaxFlags, "at most 32 flags per group");
+    Default = *flags->shadow();
+    Publish = flags;
+  };
+
+};
+
+
+#endif
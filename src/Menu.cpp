@@ -58,6 +58,8 @@ void Menu::add(Action *act) {
   Actions[NActions++] = act;
   act->setParent(this);
   act->setRoot(Root);
+  if (Root != NULL)
+    Root->invalidateFingerprint();
 }
 
 
@@ -296,11 +298,13 @@ void Menu::writeEntry(Stream &stream, size_t width) const {
 void Menu::write(Stream &stream, unsigned int roles, size_t indent,
 		 size_t width) const {
   // longest name and number of active entries:
+  bool nondefault = ((roles & NonDefault) > 0);
   size_t nn = 0;
   size_t ww = 0;
   for (size_t j=0; j<NActions; j++) {
     if (((Actions[j]->actionType() & MenuType) > 0 ||
-	 Actions[j]->enabled(roles))) {
+	 Actions[j]->enabled(roles)) &&
+	!(nondefault && Actions[j]->isDefault())) {
       nn++;
       if (Actions[j]->name() != 0 && strlen(Actions[j]->name()) > ww)
 	ww = strlen(Actions[j]->name());
@@ -315,24 +319,45 @@ void Menu::write(Stream &stream, unsigned int roles, size_t indent,
   }
   // write children:
   for (size_t j=0; j<NActions; j++) {
-    if ((Actions[j]->actionType() & MenuType) > 0 ||
-	Actions[j]->enabled(roles))
+    if (((Actions[j]->actionType() & MenuType) > 0 ||
+	 Actions[j]->enabled(roles)) &&
+	!(nondefault && Actions[j]->isDefault()))
       Actions[j]->write(stream, roles, indent, ww);
   }
 }
 
 
-void Menu::read(Stream &instream, Stream &outstream) {
+static void up_sections(char *sections, int n) {
+  for(int i=strlen(sections)-1; i>=0; i--) {
+    if (sections[i] == '>') {
+      sections[i] = '\0';
+      if (--n == 0)
+	break;
+    }
+  }
+  if (n > 0)
+    sections[0] = '\0';
+}
+
+
+size_t Menu::read(Stream &instream, Stream &outstream) {
+  size_t errors = 0;
   Action *act = NULL;
-  const size_t nline = 128;
-  char line[nline];
-  char sections[nline];
+  // lines holding arrays can be long:
+  size_t nline = 128;
+  char *line = (char *)malloc(nline);
+  if (line == NULL) {
+    outstream.println("ERROR! Not enough memory for reading configuration.");
+    return 1;
+  }
+  const size_t nsections = 128;
+  char sections[nsections];
   sections[0] = '\0';
   int indent = 0;
   int previndent = -1;
   int nind = -1;
   while (instream.available()) {
-    instream.readBytesUntil('\n', line, nline);
+    readLine(instream, line, nline);
     if (strncmp(line, "DONE", 4) == 0)
       break;
     char *key = NULL;
@@ -379,47 +404,52 @@ void Menu::read(Stream &instream, Stream &outstream) {
 	if (indent > previndent) {
 	  if (nind < 0)
 	    nind = indent - previndent;
-	  if (strlen(sections) > 0)
-	    strcat(sections, ">");
-	  strcat(sections, key);
 	}
 	else {
 	  int n = previndent - indent;
 	  n /= nind >= 0 ? nind : 2;
 	  n += 1;
-	  // n sections up:
-	  for(int i=strlen(sections)-1; i>=0; i--) {
-	    if (sections[i] == '>') {
-	      sections[i] = '\0';
-	      if (--n == 0)
-		break;
-	    }
-	  }
-	  if (n > 0)
-	    sections[0] = '\0';
-	  // add new section:
+	  up_sections(sections, n);
+	}
+	// add new section:
+	bool fits = (strlen(sections) + strlen(key) + 2 <= nsections);
+	if (fits) {
 	  if (strlen(sections) > 0)
 	    strcat(sections, ">");
 	  strcat(sections, key);
 	}
 	previndent = indent;
-	act = action(sections);
+	act = fits ? action(sections) : NULL;
 	if (act == NULL)
 	  outstream.printf("  no configuration candidate for section \"%s\" found.\n", sections);
       }
-      else if (act) {
-	for (int i=strlen(val)-1; i>=0; i--) {
-	  if (val[i] != ' ') {
-	    val[i+1] = '\0';
-	    break;
+      else {
+	if (indent <= previndent && strlen(sections) > 0) {
+	  // key of an enclosing section:
+	  int ni = nind >= 0 ? nind : 2;
+	  up_sections(sections, (previndent - indent)/ni + 1);
+	  previndent = indent - ni;
+	  act = strlen(sections) > 0 ? action(sections) : NULL;
+	}
+	if (act) {
+	  for (int i=strlen(val)-1; i>=0; i--) {
+	    if (val[i] != ' ') {
+	      val[i+1] = '\0';
+	      break;
+	    }
 	  }
+	  if (!act->hasKey(key))
+	    outstream.printf("  no configuration candidate for key \"%s\" in section \"%s\" found.\n", key, sections);
+	  else if (!act->set(val, key, outstream))
+	    errors++;
 	}
-	act->set(val, key, outstream);
       }
     }
     if (instream.available() == 0)
       delay(10);
   }
+  free(line);
+  return errors;
 }
 
 
@@ -614,16 +644,40 @@ void Menu::execute(Stream &stream) {
 }
 
 
-void Menu::set(const char *val, const char *name,
+bool Menu::set(const char *val, const char *name,
 	       Stream &stream) {
   Action *act = action(name);
   if (act == NULL) {
     if (enabled(StreamOutput))
 	stream.printf("%*s%s name \"%s\" not found.\n",
 		      indentation(), "", this->name(), name);
+    return false;
   }
-  else
-    act->set(val, this->name());
+  return act->set(val, this->name(), stream);
+}
+
+
+bool Menu::hasKey(const char *name) const {
+  for (size_t j=0; j<NActions; j++) {
+    if (strcasecmp(Actions[j]->name(), name) == 0)
+      return true;
+  }
+  return false;
+}
+
+
+bool Menu::isDefault() const {
+  for (size_t j=0; j<NActions; j++) {
+    if (!Actions[j]->isDefault())
+      return false;
+  }
+  return true;
+}
+
+
+void Menu::resetDefaults() {
+  for (size_t j=0; j<NActions; j++)
+    Actions[j]->resetDefaults();
 }
 
 
@@ -637,13 +691,63 @@ int Menu::put(int addr, Storage &storage, Stream &stream) const {
 }
 
 
-int Menu::get(int addr, bool setvalue,
+int Menu::get(int addr0, int addr1,
 	      Storage &storage, Stream &stream) {
+  int count = 0;
   for (size_t j=0; j<NActions; j++) {
-    addr = Actions[j]->get(addr, setvalue, storage, stream);
-    if (addr < 0)
-      return addr;
+    int r = Actions[j]->get(addr0, addr1, storage, stream);
+    if (r < 0)
+      return r;
+    count += r;
   }
+  return count;
+}
+
+
+size_t Menu::storageSize() const {
+  size_t n = 0;
+  for (size_t j=0; j<NActions; j++)
+    n += Actions[j]->storageSize();
+  return n;
+}
+
+
+uint32_t Menu::fingerprint(uint32_t hash) const {
+  for (size_t j=0; j<NActions; j++)
+    hash = Actions[j]->fingerprint(hash);
+  return hash;
+}
+
+
+size_t Menu::snapshotSize() const {
+  size_t n = 0;
+  for (size_t j=0; j<NActions; j++)
+    n += Actions[j]->snapshotSize();
+  return n;
+}
+
+
+int Menu::snapshotAddress(const Action *action, int addr) const {
+  for (size_t j=0; j<NActions; j++) {
+    int a = Actions[j]->snapshotAddress(action, addr);
+    if (a >= 0)
+      return a;
+    addr += Actions[j]->snapshotSize();
+  }
+  return -1;
+}
+
+
+int Menu::snapshot(int addr, Storage &storage) const {
+  for (size_t j=0; j<NActions && addr >= 0; j++)
+    addr = Actions[j]->snapshot(addr, storage);
+  return addr;
+}
+
+
+int Menu::restore(int addr, Storage &storage) {
+  for (size_t j=0; j<NActions && addr >= 0; j++)
+    addr = Actions[j]->restore(addr, storage);
   return addr;
 }
 
@@ -701,3 +805,9 @@ int Menu::receive(Storage &storage, Stream &stream) {
   return act->receive(storage, stream);
 }
 
+
+void Menu::notifyChanges() {
+  for (size_t j=0; j<NActions; j++)
+    Actions[j]->notifyChanges();
+  Action::notifyChanges();
+}
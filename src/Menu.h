@@ -115,35 +115,73 @@ class Menu : public Action {
   virtual void writeEntry(Stream &stream=Serial, size_t width=0) const;
   
   /* Write name to stream. If descend, also display name and values
-     of children. roles must be enabled. */
+     of children. roles must be enabled. If roles contains
+     NonDefault, only children differing from their defaults are
+     written. */
   virtual void write(Stream &stream=Serial,
 		     unsigned int roles=AllRoles,
 		     size_t indent=0, size_t width=0) const;
 
   /* Read configuration settings from instream as long as data are
      available or a line starting with "DONE" is encountered, and
-     report errors on outstream. */
-  virtual void read(Stream &instream=Serial, Stream &outstream=Serial);
+     report errors on outstream. Unknown sections and keys are
+     reported and skipped.
+     Return the number of invalid values. */
+  virtual size_t read(Stream &instream=Serial, Stream &outstream=Serial);
   
   /* Interactive menu via serial stream. */
   virtual void execute(Stream &stream=Serial);
 
-  /* Set the provided name-value pair and report on stream. */
-  virtual void set(const char *val, const char *name,
+  /* Set the provided name-value pair and report on stream.
+     Return false if name was not found or val was not valid. */
+  virtual bool set(const char *val, const char *name,
 		   Stream &stream=Serial);
 
+  /* True if name is the name of a child (case insensitive). */
+  virtual bool hasKey(const char *name) const;
+
+  /* True if the values of all children equal their defaults. */
+  virtual bool isDefault() const;
+
+  /* Recursively set the values of all children back to their defaults. */
+  virtual void resetDefaults();
+
   /* Write configuration with role StoragePut to addr in storage memory.
      Returns address behind this configuration, -1 on error.
      Report errors and success on stream. */
   virtual int put(int addr, Storage &storage, Stream &stream=Serial) const;
   
-  /* Read configuration with role StorageGet from addr in storage memory.
-     Only if setvalue is true set the action's value to content from storage.
-     Returns address behind this configuration, -1 on error.
+  /* Read configuration with role StorageGet from the records stored
+     between addr0 and addr1 in storage memory.
+     Returns the number of values read, -1 on error.
      Report errors and success on stream. */
-  virtual int get(int addr, bool setvalue,
+  virtual int get(int addr0, int addr1,
 		  Storage &storage, Stream &stream=Serial);
 
+  /* Number of bytes put() writes to storage memory for all children. */
+  virtual size_t storageSize() const;
+
+  /* Recursively update hash with the key, type, and size of the
+     values of all children written to storage memory. */
+  virtual uint32_t fingerprint(uint32_t hash) const;
+
+  /* Number of bytes snapshot() writes for all children. */
+  virtual size_t snapshotSize() const;
+
+  /* Recursively find the address of the values of action within the
+     values snapshot() writes to addr, -1 if action is not a child. */
+  virtual int snapshotAddress(const Action *action, int addr) const;
+
+  /* Recursively write the values of all children in their binary
+     representation to addr in storage memory.
+     Returns address behind the values, -1 on error. */
+  virtual int snapshot(int addr, Storage &storage) const;
+
+  /* Recursively read the values written by snapshot() from addr in
+     storage memory and set the values of all children accordingly.
+     Returns address behind the values, -1 on error. */
+  virtual int restore(int addr, Storage &storage);
+
   /* Recursively transmit configuration of all children using storage.
      Returns a negative number on error, zero if nothing was
      transmitted, or the number of transmitted actions on success. */
@@ -155,6 +193,10 @@ class Menu : public Action {
      or the identifier of the updated action on success. */
   virtual int receive(Storage &storage, Stream &stream=Serial);
 
+  /* Call the callbacks of all actions in this menu and then of
+     the menu itself that have been marked as changed. */
+  virtual void notifyChanges();
+
 protected:
 
   static const size_t MaxActions = 16;
@@ -8,11 +8,15 @@
 
 
 #include <Action.h>
+#include <Shared.h>
 #include <Parameter.h>
+#include <ArrayParameter.h>
+#include <FlagsParameter.h>
 #include <Menu.h>
 #include <Config.h>
 
 #include <Storage.h>
+#include <FileStorage.h>
 
 #include <MessageAction.h>
 #include <InfoAction.h>
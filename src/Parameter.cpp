@@ -5,10 +5,16 @@
 
 Parameter::Parameter(Menu &menu, const char *name, size_t n, Modes mode) :
   Action(menu, name, ParameterRoles, mode),
+  NSelection(n),
   ID(-1),
-  NSelection(n) {
+  Publish(NULL),
+  SelectionIndex(NULL) {
   ActType = ParameterType;
-  TypeStr[0] = '\0';
+}
+
+
+Parameter::~Parameter() {
+  delete[] SelectionIndex;
 }
 
 
@@ -26,20 +32,22 @@ int Parameter::setIdentifier(int id) {
 
 
 void Parameter::writeEntry(Stream &stream, size_t width) const {
-  char pval[MaxVal];
-  valueStr(pval);
   size_t kw = width >= strlen(name()) ? width - strlen(name()) : 0;
-  stream.printf("%s:%*s %s\n", name(), kw, "", pval);
+  stream.printf("%s:%*s ", name(), kw, "");
+  writeValue(stream);
+  stream.print('\n');
 }
 
 
 void Parameter::write(Stream &stream, unsigned int roles, size_t indent,
 		      size_t width) const {
+  if ((roles & NonDefault) > 0 && isDefault())
+    return;
   if (enabled(roles)) {
-    char pval[MaxVal];
-    valueStr(pval);
     size_t kw = width >= strlen(name()) ? width - strlen(name()) : 0;
-    stream.printf("%*s%s:%*s %s\n", indent, "", name(), kw, "", pval);
+    stream.printf("%*s%s:%*s ", indent, "", name(), kw, "");
+    writeValue(stream);
+    stream.print('\n');
   }
 }
 
@@ -56,8 +64,9 @@ void Parameter::execute(Stream &stream) {
   if (w < 16)
     w = 16;
   char pval[MaxVal];
-  valueStr(pval);
-  stream.printf("%-*s: %s\n", w, name(), pval);
+  stream.printf("%-*s: ", w, name());
+  writeValue(stream);
+  stream.print('\n');
   listSelection(stream);
   while (true) {
     if (NSelection > 0)
@@ -72,22 +81,28 @@ void Parameter::execute(Stream &stream) {
       yield();
       delay(1);
     }
-    stream.readBytesUntil('\n', pval, MaxVal);
-    if ((strcmp(pval, "ktv") == 0) ||
-	(strcmp(pval, "keepthevalue") == 0) ||
-	parseValue(pval, NSelection > 0)) {
-      if (echo())
-	stream.println(pval);
+    // values of arrays can be longer than MaxVal:
+    size_t nval = MaxVal;
+    char *val = (char *)malloc(nval);
+    if (val == NULL) {
+      stream.println("ERROR! Not enough memory for reading the value.");
       break;
     }
+    readLine(stream, val, nval);
+    bool done = ((strcmp(val, "ktv") == 0) ||
+		 (strcmp(val, "keepthevalue") == 0) ||
+		 parseValue(val, NSelection > 0));
     if (echo())
-      stream.println(pval);
+      stream.println(val);
+    free(val);
+    if (done)
+      break;
   }
   stream.println();
 }
 
 
-void Parameter::set(const char *val, const char *name, Stream &stream) {
+bool Parameter::set(const char *val, const char *name, Stream &stream) {
   size_t kn = 0;
   if (name != 0)
     kn = strlen(name);
@@ -102,110 +117,127 @@ void Parameter::set(const char *val, const char *name, Stream &stream) {
     if (enabled(StreamOutput))
       stream.printf("%*ssetting a new value for %s is disabled\n",
 		    indentation(), "", keyname);
-    return;
+    return true;
   }
-  char pval[MaxVal];
-  strncpy(pval, val, MaxVal);
-  pval[MaxVal-1] = '\0';
+  // values of arrays can be longer than MaxVal:
+  size_t n = strlen(val) + 1;
+  char pval[n > MaxVal ? n : MaxVal];
+  strcpy(pval, val);
   bool r = parseValue(pval, false);
   if (disabled(StreamOutput))
-    return;
+    return r;
   if (r) {
-    valueStr(pval);
-    stream.printf("%*sset %-25s to %s\n",
-		  indentation(), "", keyname, pval);
+    if (Root == NULL || !Root->staging()) {
+      stream.printf("%*sset %-25s to ", indentation(), "", keyname);
+      writeValue(stream);
+      stream.print('\n');
+    }
   }
   else
     stream.printf("%*s%s is not a valid value for %s\n",
 		  indentation(), "", val, keyname);
-}
-
-
-void Parameter::makeIdentifier(char ident[NIdent]) const {
-  size_t i = strlen(name());
-  i /= 2;
-  if (i == 0)
-    i = 1;
-  if (i >= strlen(name()))
-    i = strlen(name()) - 1;
-  ident[0] = uint8_t(identifier());
-  ident[1] = name()[0];
-  ident[2] = name()[i];
-  ident[3] = name()[strlen(name()) - 1];
+  return r;
 }
 
 
 int Parameter::put(int addr, Storage &storage, Stream &stream) const {
   if (disabled(StoragePut) || name() == 0 || strlen(name()) == 0)
     return addr;
-  // write identifier:
-  if ((ID < 0) && (Root != NULL))
-    Root->setIdentifier();
-  char ident[NIdent];
-  makeIdentifier(ident);
-  if (!storage.put(addr, ident))
+  // write record header:
+  addr = putRecord(addr, storage, key(), valueType(), valueSize());
+  if (addr < 0)
     return -1;
-  addr += NIdent;
   // write value:
   int addr1 = putValue(addr, storage);
-  if (addr1 < 0 || addr1 >= storage.length())
+  if (addr1 < 0 || addr1 >= (int)storage.length())
     return -1;
-  char s[MaxVal];
-  valueStr(s);
-  stream.printf("Wrote %s with value \"%s\" ", name(), s);
-  stream.printf("to storage at address %04x\n", addr);
+  stream.printf("Wrote %s with value \"", name());
+  writeValue(stream);
+  stream.printf("\" to storage at address %04x\n", addr);
   return addr1;
 }
 
 
-int Parameter::get(int addr, bool setvalue,
+int Parameter::get(int addr0, int addr1,
 		   Storage &storage, Stream &stream) {
-  if (disabled(StoragePut) || name() == 0 || strlen(name()) == 0)
-    return addr;
-  if (disabled(StorageGet) || disabled(SetValue))
-    setvalue = false;
-  if (setvalue) {
-    // check identifier:
-    if ((ID < 0) && (Root != NULL))
-      Root->setIdentifier();
-    char p_ident[NIdent];
-    makeIdentifier(p_ident);
-    char e_ident[NIdent];
-    if (!storage.get(addr, e_ident) || memcmp(p_ident, e_ident, NIdent) != 0) {
-      if (enabled(StreamOutput))
-	stream.printf("Failed to read value for %s from storage memory.\n",
-		      name());
-      return -1;
-    }
-    addr += NIdent;
-    // read value:
-    int addr1 = getValue(addr, true, storage);
-    if (addr1 < 0)
-      return -1;
-    if (enabled(StreamOutput)) {
-      size_t kn = strlen(name()) + 1;
-      if (parent() != 0 && strlen(parent()->name()) > 0)
-	kn += strlen(parent()->name()) + 1;
-      char keyname[kn];
-      keyname[0] = '\0';
-      if (parent() != 0 && strlen(parent()->name()) > 0) {
-	strcpy(keyname, parent()->name());
-	strcat(keyname, ">");
-      }
-      strcat(keyname, name());
-      char pval[MaxVal];
-      valueStr(pval);
-      stream.printf("%*sset %-25s to %-25s from storage address %04x\n",
-		    indentation(), "", keyname, pval, addr);
-    }
-    return addr1;
+  if (disabled(StorageGet) || disabled(SetValue) ||
+      name() == 0 || strlen(name()) == 0)
+    return 0;
+  // find record:
+  uint8_t type;
+  uint16_t size;
+  int addr = findRecord(key(), addr0, addr1, storage, type, size);
+  if (addr < 0) {
+    if (enabled(StreamOutput))
+      stream.printf("%*sno value for %s in storage memory\n",
+		    indentation(), "", name());
+    return 0;
   }
-  else {
-    addr = getValue(addr, false, storage);
-    if (addr < 0)
-      return -1;
-    return addr + NIdent;
+  if (type != valueType() ||
+      (type != StringValue && size != valueSize())) {
+    if (enabled(StreamOutput))
+      stream.printf("%*sstored value for %s does not match type of parameter\n",
+		    indentation(), "", name());
+    return 0;
   }
+  // read value:
+  if (getValue(addr, size, storage) < 0) {
+    if (enabled(StreamOutput))
+      stream.printf("Failed to read value for %s from storage memory.\n",
+		    name());
+    return -1;
+  }
+  if (enabled(StreamOutput)) {
+    size_t kn = strlen(name()) + 1;
+    if (parent() != 0 && strlen(parent()->name()) > 0)
+      kn += strlen(parent()->name()) + 1;
+    char keyname[kn];
+    keyname[0] = '\0';
+    if (parent() != 0 && strlen(parent()->name()) > 0) {
+      strcpy(keyname, parent()->name());
+      strcat(keyname, ">");
+    }
+    strcat(keyname, name());
+    stream.printf("%*sset %-25s to ", indentation(), "", keyname);
+    size_t n = writeValue(stream);
+    stream.printf("%*s from storage address %04x\n",
+		  n < 25 ? 25 - n : 0, "", addr);
+  }
+  return 1;
+}
+
+
+size_t Parameter::storageSize() const {
+  if (disabled(StoragePut) || name() == 0 || strlen(name()) == 0)
+    return 0;
+  return NRecord + valueSize();
+}
+
+
+uint32_t Parameter::fingerprint(uint32_t hash) const {
+  if (disabled(StoragePut) || name() == 0 || strlen(name()) == 0)
+    return hash;
+  uint32_t k = key();
+  uint16_t size = valueSize();
+  uint8_t record[NRecord];
+  memcpy(record, &k, sizeof(k));
+  record[4] = valueType();
+  memcpy(record + 5, &size, sizeof(size));
+  for (size_t i=0; i<NRecord; i++)
+    hash = (hash ^ record[i]) * 16777619UL;
+  return hash;
+}
+
+
+int Parameter::snapshot(int addr, Storage &storage) const {
+  return putValue(addr, storage);
+}
+
+
+int Parameter::restore(int addr, Storage &storage) {
+  if (disabled(SetValue))
+    return addr + valueSize();
+  return getValue(addr, valueSize(), storage);
 }
 
 
@@ -214,11 +246,11 @@ int Parameter::transmit(Storage &storage, Stream &stream) const {
     return 0;
   if ((ID < 0) && (Root != NULL))
     Root->setIdentifier();
-  char s[MaxVal];
-  valueStr(s);
   if (enabled(StreamOutput)) {
-    stream.printf("transmit \"%s\" (id %d) with value \"%s\" ",
-		  name(), identifier(), s);
+    stream.printf("transmit \"%s\" (id %d) with value \"",
+		  name(), identifier());
+    writeValue(stream);
+    stream.print("\" ");
   }
   if (! storage.put(1, true)) {
     if (enabled(StreamOutput))
@@ -248,7 +280,7 @@ int Parameter::receive(Storage &storage, Stream &stream) {
   if (disabled(BusReceive))
     return 0;
   // read value:
-  if (getValue(3, true, storage) < 0)
+  if (getValue(3, valueSize(), storage) < 0)
     return -1;
   if (enabled(StreamOutput)) {
     size_t kn = strlen(name()) + 1;
@@ -261,19 +293,71 @@ int Parameter::receive(Storage &storage, Stream &stream) {
       strcat(keyname, ">");
     }
     strcat(keyname, name());
-    char pval[MaxVal];
-    valueStr(pval);
-    stream.printf(" -> set %-25s to %-25s\n", keyname, pval);
+    stream.printf(" -> set %-25s to ", keyname);
+    writeValue(stream);
+    stream.print('\n');
   }
   return ID;
 }
 
 
+size_t Parameter::writeValue(Stream &stream) const {
+  char pval[MaxVal];
+  valueStr(pval);
+  return stream.print(pval);
+}
+
+
 void Parameter::setNSelection(size_t n) {
   NSelection = n;
 }
 
 
+bool Parameter::getStaged(void *val, size_t size) const {
+  if (Root == NULL || size != valueSize())
+    return false;
+  const uint8_t *staged = Root->stagedValue(this);
+  if (staged == NULL)
+    return false;
+  memcpy(val, staged, size);
+  return true;
+}
+
+
+bool Parameter::setStaged(const void *val, size_t size) {
+  if (Root == NULL || size != valueSize())
+    return false;
+  uint8_t *staged = Root->stagedValue(this);
+  if (staged == NULL)
+    return false;
+  memcpy(staged, val, size);
+  return true;
+}
+
+
+void Parameter::changeString(char *value, const char *str, size_t n) {
+  if (Root != NULL && Root->staging()) {
+    char staged[n];
+    strncpy(staged, str, n);
+    staged[n - 1] = '\0';
+    if (setStaged(staged, n))
+      return;
+  }
+  if (strncmp(value, str, n - 1) == 0)
+    return;
+  strncpy(value, str, n);
+  value[n - 1] = '\0';
+  notifyValue();
+}
+
+
+void Parameter::notifyValue() {
+  if (Publish != NULL)
+    Publish->publish();
+  notifyChange();
+}
+
+
 void Parameter::instructions(char *str) const {
   *str = '\0';
   if (detailed()) {
@@ -284,79 +368,1075 @@ void Parameter::instructions(char *str) const {
       *sp++ = 'A';
     *sp++ = ',';
     *sp++ = ' ';
-    strcpy(sp, TypeStr);
+    typeStr(sp);
   }
 }
 
 
-char Parameter::UnitPref[NUnits][6] = {
-  "Deka", "deka", "Hekto", "hekto", "kilo", "Kilo", 
-  "Mega", "mega", "Giga", "giga", "Tera", "tera", 
-  "Peta", "peta", "Exa", "exa", 
-  "Dezi", "dezi", "Zenti", "centi", "Micro", "micro", 
-  "Milli", "milli", "Nano", "nano", "Piko", "piko", 
-  "Femto", "femto", "Atto", "atto", 
-  "da", "h", "K", "k", "M", "G", "T", "P", "E", 
-  "d", "c", "mu", "u", "m", "n", "p", "f", "a"
+// FNV-1a hash over the lower-case names of action and its parent
+// menus (excluding the root menu) separated by '>'.
+static uint32_t hash_path(const Action *action) {
+  uint32_t hash = 2166136261UL;
+  const Menu *parent = action->parent();
+  if (parent != 0 && parent->parent() != 0) {
+    hash = hash_path(parent);
+    hash = (hash ^ '>') * 16777619UL;
+  }
+  for (const char *cp = action->name(); cp != 0 && *cp != '\0'; cp++)
+    hash = (hash ^ uint8_t(tolower(*cp))) * 16777619UL;
+  return hash;
+}
+
+
+uint32_t Parameter::key() const {
+  uint32_t hash = hash_path(this);
+  // EndKey and erased memory are no valid keys:
+  if (hash == EndKey || hash == 0xffffffff)
+    hash = 1;
+  return hash;
+}
+
+
+int Parameter::putRecord(int addr, Storage &storage, uint32_t key,
+			 uint8_t type, uint16_t size) {
+  if (!storage.put(addr, key) ||
+      !storage.put(addr + 4, type) ||
+      !storage.put(addr + 5, size))
+    return -1;
+  return addr + NRecord;
+}
+
+
+int Parameter::getRecord(int addr, Storage &storage, uint32_t &key,
+			 uint8_t &type, uint16_t &size) {
+  if (addr < 0 || addr + 4 > (int)storage.length() ||
+      !storage.get(addr, key) || key == EndKey || key == 0xffffffff)
+    return -1;
+  if (addr + (int)NRecord > (int)storage.length() ||
+      !storage.get(addr + 4, type) ||
+      !storage.get(addr + 5, size))
+    return -1;
+  return addr + NRecord;
+}
+
+
+int Parameter::findRecord(uint32_t key, int addr0, int addr1,
+			  Storage &storage, uint8_t &type, uint16_t &size) {
+  int addr = addr0;
+  while (addr < addr1) {
+    uint32_t rkey;
+    addr = getRecord(addr, storage, rkey, type, size);
+    if (addr < 0)
+      return -1;
+    if (rkey == key)
+      return addr;
+    addr += size;
+  }
+  return -1;
+}
+
+
+// Dimensions of base units:
+enum UnitDimension : uint8_t {
+  UnknownDim = 0,
+  TimeDim,
+  FrequencyDim,
+  VoltageDim,
+  CurrentDim,
+  PowerDim,
+  ResistanceDim,
+  CapacitanceDim,
+  LengthDim,
+  MassDim,
+  DataDim,
+  LevelDim,
+  AngleDim,
+  RatioDim
+};
+
+
+// A unit prefix or a base unit with its dimension and
+// factor Multiplier*10^Exponent:
+struct UnitDef {
+  const char *Name;
+  int8_t Exponent;
+  uint32_t Multiplier = 1;
+  uint8_t Dimension = UnknownDim;
+};
+
+
+// adapted from https://github.com/relacs/relacs/blob/1facade622a80e9f51dbf8e6f8171ac74c27f100/options/src/parameter.cc#L1647-L1703
+static constexpr UnitDef UnitPrefixes[] = {
+  {"Deka", 1}, {"deka", 1}, {"Hekto", 2}, {"hekto", 2},
+  {"kilo", 3}, {"Kilo", 3}, {"Mega", 6}, {"mega", 6},
+  {"Giga", 9}, {"giga", 9}, {"Tera", 12}, {"tera", 12},
+  {"Peta", 15}, {"peta", 15}, {"Exa", 18}, {"exa", 18},
+  {"Dezi", -1}, {"dezi", -1}, {"Zenti", -2}, {"centi", -2},
+  {"Micro", -6}, {"micro", -6}, {"Milli", -3}, {"milli", -3},
+  {"Nano", -9}, {"nano", -9}, {"Piko", -12}, {"piko", -12},
+  {"Femto", -15}, {"femto", -15}, {"Atto", -18}, {"atto", -18},
+  {"da", 1}, {"h", 2}, {"K", 3}, {"k", 3}, {"M", 6},
+  {"G", 9}, {"T", 12}, {"P", 15}, {"E", 18},
+  {"d", -1}, {"c", -2}, {"mu", -6}, {"u", -6}, {"\xc2\xb5", -6},
+  {"m", -3}, {"n", -9}, {"p", -12}, {"f", -15}, {"a", -18}
 };
 
 
-float Parameter::UnitFac[NUnits] = {
-  1e1,  1e1,  1e2,  1e2,  1e3,  1e3,  
-  1e6,  1e6,  1e9,  1e9,  1e12, 1e12, 
-  1e15, 1e15, 1e18, 1e18,
-  1e-1, 1e-1, 1e-2, 1e-2, 1e-6, 1e-6, 
-  1e-3, 1e-3, 1e-9, 1e-9, 1e-12, 1e-12, 
-  1e-15, 1e-15, 1e-18, 1e-18, 
-  1e1,  1e2,  1e3,  1e3,  1e6,  1e9, 1e12, 1e15, 1e18,
-  1e-1, 1e-2, 1e-6, 1e-6, 1e-3, 1e-9, 1e-12, 1e-15, 1e-18
+static constexpr UnitDef BaseUnits[] = {
+  {"s", 0, 1, TimeDim}, {"min", 0, 60, TimeDim},
+  {"h", 0, 3600, TimeDim}, {"hour", 0, 3600, TimeDim},
+  {"Hz", 0, 1, FrequencyDim},
+  {"V", 0, 1, VoltageDim},
+  {"A", 0, 1, CurrentDim},
+  {"W", 0, 1, PowerDim},
+  {"Ohm", 0, 1, ResistanceDim},
+  {"F", 0, 1, CapacitanceDim},
+  {"m", 0, 1, LengthDim},
+  {"g", 0, 1, MassDim},
+  {"B", 0, 1, DataDim}, {"bit", -3, 125, DataDim},
+  {"dB", 0, 1, LevelDim},
+  {"deg", 0, 1, AngleDim}, {"rad", -5, 5729578, AngleDim},
+  {"1", 0, 1, RatioDim}, {"%", -2, 1, RatioDim}
 };
 
 
+/* Trie over the names of a table of unit definitions.
+   Each node holds a character, its first child and its next sibling,
+   and the index of the definition ending at this node (-1 if none).
+   Node 0 is the root. */
+template<size_t N>
+struct UnitTrie {
+  char Chars[N];
+  uint8_t Child[N];
+  uint8_t Sibling[N];
+  int8_t Def[N];
+  size_t NNodes;
+};
+
+
+// Upper limit for the number of trie nodes needed for defs:
+template<size_t M>
+static constexpr size_t unit_chars(const UnitDef (&defs)[M]) {
+  size_t n = 1;
+  for (size_t i=0; i<M; i++) {
+    for (const char *c=defs[i].Name; *c != '\0'; ++c)
+      n++;
+  }
+  return n;
+}
+
+
+// Build the trie for defs at compile time:
+template<size_t N, size_t M>
+static constexpr UnitTrie<N> make_unit_trie(const UnitDef (&defs)[M]) {
+  static_assert(N <= 256 && M <= 128, "unit table too large");
+  UnitTrie<N> trie{};
+  trie.NNodes = 1;
+  trie.Def[0] = -1;
+  for (size_t i=0; i<M; i++) {
+    size_t node = 0;
+    for (const char *c=defs[i].Name; *c != '\0'; ++c) {
+      size_t k = trie.Child[node];
+      while (k > 0 && trie.Chars[k] != *c)
+	k = trie.Sibling[k];
+      if (k == 0) {
+	k = trie.NNodes++;
+	trie.Chars[k] = *c;
+	trie.Child[k] = 0;
+	trie.Sibling[k] = trie.Child[node];
+	trie.Def[k] = -1;
+	trie.Child[node] = k;
+      }
+      node = k;
+    }
+    trie.Def[node] = i;
+  }
+  return trie;
+}
+
+
+static constexpr size_t NPrefixNodes =
+  make_unit_trie<unit_chars(UnitPrefixes)>(UnitPrefixes).NNodes;
+static constexpr UnitTrie<NPrefixNodes> PrefixTrie =
+  make_unit_trie<NPrefixNodes>(UnitPrefixes);
+
+static constexpr size_t NBaseNodes =
+  make_unit_trie<unit_chars(BaseUnits)>(BaseUnits).NNodes;
+static constexpr UnitTrie<NBaseNodes> BaseTrie =
+  make_unit_trie<NBaseNodes>(BaseUnits);
+
+
+// Child of node in trie with character c, 0 if there is none:
+template<size_t N>
+static size_t trie_child(const UnitTrie<N> &trie, size_t node, char c) {
+  size_t k = trie.Child[node];
+  while (k > 0 && trie.Chars[k] != c)
+    k = trie.Sibling[k];
+  return k;
+}
+
+
+// Index of the definition in trie matching str, -1 if there is none:
+template<size_t N>
+static int trie_find(const UnitTrie<N> &trie, const char *str) {
+  size_t node = 0;
+  for (; *str != '\0'; ++str) {
+    node = trie_child(trie, node, *str);
+    if (node == 0)
+      return -1;
+  }
+  return trie.Def[node];
+}
+
+
+// Split unit into an optional prefix and a remaining unit.
+// Return in rest and exponents at most n splits, starting with the
+// unsplit unit, and return the number of splits.
+static size_t split_unit(const char *unit, const char **rest,
+			 int *exponents, size_t n) {
+  size_t m = 0;
+  if (m < n) {
+    rest[m] = unit;
+    exponents[m++] = 0;
+  }
+  size_t node = 0;
+  for (const char *c=unit; *c != '\0' && m < n; ++c) {
+    node = trie_child(PrefixTrie, node, *c);
+    if (node == 0)
+      break;
+    int k = PrefixTrie.Def[node];
+    if (k >= 0 && *(c + 1) != '\0') {
+      rest[m] = c + 1;
+      exponents[m++] = UnitPrefixes[k].Exponent;
+    }
+  }
+  return m;
+}
+
+
+// Factor multiplier*10^exponent and dimension of unit relative to
+// the base unit of its dimension.
+// Units with an unknown base unit get UnknownDim,
+// an empty unit is dimensionless like "1".
+static void parse_unit(const char *unit, int &exponent,
+		       uint32_t &multiplier, uint8_t &dimension) {
+  exponent = 0;
+  multiplier = 1;
+  dimension = UnknownDim;
+  if (unit[0] == '\0') {
+    dimension = RatioDim;
+    return;
+  }
+  const char *rest[4];
+  int exponents[4];
+  size_t n = split_unit(unit, rest, exponents, 4);
+  // the unsplit unit first, e.g. "min" or "dB", then longest prefix first:
+  for (size_t k=0; k<n; k++) {
+    size_t j = k == 0 ? 0 : n - k;
+    int i = trie_find(BaseTrie, rest[j]);
+    if (i >= 0) {
+      exponent = exponents[j] + BaseUnits[i].Exponent;
+      multiplier = BaseUnits[i].Multiplier;
+      dimension = BaseUnits[i].Dimension;
+      return;
+    }
+  }
+}
+
+
+// Factor (oldmult/newmult)*10^exponent converting values from
+// oldunit to newunit. Return false if the units are not compatible.
+static bool unit_scale(const char *oldunit, const char *newunit,
+		       int &exponent, uint32_t &oldmult, uint32_t &newmult) {
+  exponent = 0;
+  oldmult = 1;
+  newmult = 1;
+  // missing or identical unit?
+  if (newunit == 0 || oldunit == 0 || strcmp(oldunit, newunit) == 0)
+    return true;
+  int oldexp;
+  uint8_t olddim;
+  parse_unit(oldunit, oldexp, oldmult, olddim);
+  int newexp;
+  uint8_t newdim;
+  parse_unit(newunit, newexp, newmult, newdim);
+  if (olddim != newdim) {
+    // an empty unit is compatible with any other unit:
+    oldmult = 1;
+    newmult = 1;
+    return oldunit[0] == '\0' || newunit[0] == '\0';
+  }
+  if (olddim != UnknownDim) {
+    exponent = oldexp - newexp;
+    return true;
+  }
+  // unknown base units need to match, e.g. "mV/Pa" and "V/Pa":
+  const char *oldrest[4];
+  int oldexps[4];
+  size_t nold = split_unit(oldunit, oldrest, oldexps, 4);
+  const char *newrest[4];
+  int newexps[4];
+  size_t nnew = split_unit(newunit, newrest, newexps, 4);
+  for (size_t i=0; i<nold; i++) {
+    for (size_t j=0; j<nnew; j++) {
+      if (strcmp(oldrest[i], newrest[j]) == 0) {
+	exponent = oldexps[i] - newexps[j];
+	return true;
+      }
+    }
+  }
+  return false;
+}
+
+
+bool Parameter::unitFactor(const char *oldunit, const char *newunit,
+			   double &factor) {
+  factor = 1.0;
+  int exponent;
+  uint32_t oldmult;
+  uint32_t newmult;
+  if (!unit_scale(oldunit, newunit, exponent, oldmult, newmult))
+    return false;
+  double p = 1.0;
+  for (int k=0; k<abs(exponent); k++)
+    p *= 10.0;
+  factor = double(oldmult)/double(newmult);
+  if (exponent > 0)
+    factor *= p;
+  else
+    factor /= p;
+  return true;
+}
+
+
+bool Parameter::unitFactor(const char *oldunit, const char *newunit,
+			   float &factor) {
+  double f = 1.0;
+  bool r = unitFactor(oldunit, newunit, f);
+  factor = f;
+  return r;
+}
+
+
+// Greatest common divisor:
+static uint64_t gcd(uint64_t a, uint64_t b) {
+  while (b > 0) {
+    uint64_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+
+// Multiply a by 10^exponent. Return false on overflow.
+static bool mul_pow10(uint64_t &a, int exponent) {
+  for (int k=0; k<exponent; k++) {
+    if (a > UINT64_MAX/10)
+      return false;
+    a *= 10;
+  }
+  return true;
+}
+
+
+bool Parameter::unitRatio(const char *oldunit, const char *newunit,
+			  uint64_t &num, uint64_t &den) {
+  num = 1;
+  den = 1;
+  int exponent;
+  uint32_t oldmult;
+  uint32_t newmult;
+  if (!unit_scale(oldunit, newunit, exponent, oldmult, newmult))
+    return false;
+  uint64_t n = oldmult;
+  uint64_t d = newmult;
+  if (!mul_pow10(exponent > 0 ? n : d, abs(exponent)))
+    return false;
+  uint64_t g = gcd(n, d);
+  num = n/g;
+  den = d/g;
+  return true;
+}
+
+
 float Parameter::changeUnit(float val, const char *oldunit,
 			    const char *newunit) {
-  // adapted from https://github.com/relacs/relacs/blob/1facade622a80e9f51dbf8e6f8171ac74c27f100/options/src/parameter.cc#L1647-L1703
-
-  // missing unit?
-  if (newunit == 0 || strlen(newunit) == 0 ||
-      oldunit == 0 || strlen(oldunit) == 0)
+  float factor = 1.0;
+  if (!unitFactor(oldunit, newunit, factor))
     return val;
+  return val * factor;
+}
 
-  // parse old unit:
-  float f1 = 1.0;
-  if (strcmp(oldunit, "%") == 0)
-    f1 = 0.01;
-  else if (strcmp(oldunit, "hour") == 0 || strcmp(oldunit, "h") == 0)
-    f1 = 60.0*60.0;
-  else if (strcmp(oldunit, "min") == 0)
-    f1 = 60.0;
-  else {
-    int k = 0;
-    for (k=0; k<NUnits; k++)
-      if (strncmp(oldunit, UnitPref[k], strlen(UnitPref[k])) == 0)
+
+const char *Parameter::parseDecimal(const char *str, bool &negative,
+				    uint64_t &mantissa, int &exponent,
+				    bool &exact) {
+  negative = false;
+  mantissa = 0;
+  exponent = 0;
+  exact = true;
+  const char *sp = str;
+  if (*sp == '+' || *sp == '-')
+    negative = (*sp++ == '-');
+  // hexadecimal or binary integer literal:
+  if (sp[0] == '0' && (sp[1] == 'x' || sp[1] == 'X' ||
+		       sp[1] == 'b' || sp[1] == 'B')) {
+    int shift = (sp[1] == 'x' || sp[1] == 'X') ? 4 : 1;
+    const char *dp = sp + 2;
+    for (; *dp != '\0'; ++dp) {
+      int d = -1;
+      if (*dp >= '0' && *dp <= '9')
+	d = *dp - '0';
+      else if (*dp >= 'a' && *dp <= 'f')
+	d = *dp - 'a' + 10;
+      else if (*dp >= 'A' && *dp <= 'F')
+	d = *dp - 'A' + 10;
+      if (d < 0 || d >= (1 << shift))
 	break;
-    if (k < NUnits && strlen(UnitPref[k]) < strlen(oldunit))
-      f1 = UnitFac[k];
+      if (mantissa >> (64 - shift) != 0)
+	return str;
+      mantissa = (mantissa << shift) | d;
+    }
+    // otherwise a zero followed by a unit, like "0bit":
+    if (dp > sp + 2)
+      return dp;
+    mantissa = 0;
+  }
+  bool digits = false;
+  bool point = false;
+  for (; *sp != '\0'; ++sp) {
+    if (*sp == '.' && !point) {
+      point = true;
+      continue;
+    }
+    if (!isdigit(*sp))
+      break;
+    digits = true;
+    int d = *sp - '0';
+    if (mantissa < UINT64_MAX/10 ||
+	(mantissa == UINT64_MAX/10 && d <= int(UINT64_MAX%10))) {
+      mantissa = 10*mantissa + d;
+      if (point)
+	exponent--;
+    }
+    else if (!point) {
+      exponent++;
+      if (d > 0)
+	exact = false;
+    }
+  }
+  if (!digits)
+    return str;
+  // exponent, but not the start of a unit like "exa":
+  if ((*sp == 'e' || *sp == 'E') &&
+      (isdigit(sp[1]) ||
+       ((sp[1] == '+' || sp[1] == '-') && isdigit(sp[2])))) {
+    ++sp;
+    bool negexp = false;
+    if (*sp == '+' || *sp == '-')
+      negexp = (*sp++ == '-');
+    int e = 0;
+    for (; isdigit(*sp); ++sp) {
+      if (e < 1000)
+	e = 10*e + (*sp - '0');
+    }
+    exponent += negexp ? -e : e;
+  }
+  return sp;
+}
+
+
+double Parameter::decimalValue(const char *str, bool negative,
+			       uint64_t mantissa, int exponent) {
+  static const double pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  // exact mantissa and power of ten result in a single rounding:
+  if (mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+    double v = double(mantissa);
+    if (exponent < 0)
+      v /= pow10[-exponent];
+    else
+      v *= pow10[exponent];
+    return negative ? -v : v;
+  }
+  return strtod(str, NULL);
+}
+
+
+bool Parameter::scaleDecimal(uint64_t mantissa, int exponent,
+			     uint64_t num, uint64_t den, uint64_t &value) {
+  value = 0;
+  if (mantissa == 0 || num == 0)
+    return true;
+  // fold the exponent into num and den:
+  if (exponent > 0) {
+    uint64_t g = gcd(mantissa, den);
+    mantissa /= g;
+    den /= g;
+    if (!mul_pow10(mantissa, exponent))
+      return false;
   }
-  
-  // parse new unit:
-  float f2 = 1.0;
-  if (strcmp(newunit, "%") == 0)
-    f2 = 0.01;
-  else if (strcmp(newunit, "hour") == 0 || strcmp(newunit, "h") == 0)
-    f2 = 60.0*60.0;
-  else if (strcmp(newunit, "min") == 0)
-    f2 = 60.0;
   else {
-    int k = 0;
-    for (k=0; k<NUnits; k++)
-      if (strncmp(newunit, UnitPref[k], strlen(UnitPref[k])) == 0)
+    uint64_t d = den;
+    while (exponent < 0 && !mul_pow10(d = den, -exponent)) {
+      // drop digits that do not matter:
+      mantissa = (mantissa + 5)/10;
+      exponent++;
+    }
+    den = d;
+  }
+  // round(mantissa*num/den) without overflow:
+  uint64_t g = gcd(mantissa, den);
+  mantissa /= g;
+  den /= g;
+  g = gcd(num, den);
+  num /= g;
+  den /= g;
+  uint64_t q = mantissa/den;
+  uint64_t r = mantissa%den;
+  if (q > 0 && num > UINT64_MAX/q)
+    return false;
+  value = q*num;
+  // r*num/den with r < den:
+  uint64_t f = 0;
+  if (r > 0) {
+    if (num <= UINT64_MAX/r)
+      f = (r*num + den/2)/den;
+    else {
+      uint64_t qn = num/den;
+      uint64_t rn = num%den;
+      if (rn > 0 && r > UINT64_MAX/rn)
+	return false;
+      f = r*qn + (r*rn + den/2)/den;
+    }
+  }
+  if (value > UINT64_MAX - f)
+    return false;
+  value += f;
+  return true;
+}
+
+
+// A decimal number Mantissa*10^Exponent*Num/Den:
+struct Decimal {
+  uint64_t Mantissa;
+  int Exponent;
+  uint64_t Num;
+  uint64_t Den;
+};
+
+
+// Return in v the number d multiplied by 10^prec and rounded to an integer.
+// Return false on overflow.
+static bool scale_decimal(const Decimal &d, int prec, uint64_t &v) {
+  return Parameter::scaleDecimal(d.Mantissa, d.Exponent + prec,
+				 d.Num, d.Den, v);
+}
+
+
+// Number of decimal digits of v:
+static int count_digits(uint64_t v) {
+  int n = 1;
+  for (; v >= 10; v /= 10)
+    n++;
+  return n;
+}
+
+
+// Write the digits of v in base with at least mindigits digits
+// into buf. Return the number of digits.
+static int write_digits(char *buf, uint64_t v, int base, bool upper,
+			int mindigits) {
+  const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  char tmp[72];
+  int n = 0;
+  do {
+    tmp[n++] = digits[v % base];
+    v /= base;
+  } while (v > 0);
+  while (n < mindigits && n < 64)
+    tmp[n++] = '0';
+  for (int k=0; k<n; k++)
+    buf[k] = tmp[n-1-k];
+  buf[n] = '\0';
+  return n;
+}
+
+
+// Round d to sig significant digits.
+// Return the digits in v and the decimal exponent of the first digit
+// in exponent. Return false on overflow.
+static bool significant_digits(const Decimal &d, int sig,
+			       uint64_t &v, int &exponent) {
+  v = 0;
+  exponent = 0;
+  if (d.Mantissa == 0 || d.Num == 0)
+    return true;
+  // estimate exponent:
+  exponent = count_digits(d.Mantissa) + d.Exponent +
+    count_digits(d.Num) - count_digits(d.Den) - 1;
+  // adjust exponent to rounding:
+  uint64_t lower = 1;
+  for (int k=1; k<sig; k++)
+    lower *= 10;
+  for (int k=0; k<4; k++) {
+    if (!scale_decimal(d, sig-1-exponent, v))
+      return false;
+    if (v < lower)
+      exponent--;
+    else if (v/10 >= lower)
+      exponent++;
+    else
+      return true;
+  }
+  return false;
+}
+
+
+// Remove trailing zeros and a trailing decimal point from the
+// fractional part of the number in buf.
+static void strip_zeros(char *buf) {
+  char *point = strchr(buf, '.');
+  if (point == NULL)
+    return;
+  char *end = point + strlen(point);
+  while (end > point + 1 && *(end - 1) == '0')
+    end--;
+  if (end == point + 1)
+    end = point;
+  *end = '\0';
+}
+
+
+// Write d in fixed-point notation with prec decimals into buf.
+// On overflow, reduce prec and return false.
+static bool fixed_body(char *buf, const Decimal &d, int prec, bool alt) {
+  uint64_t v = 0;
+  bool r = true;
+  while (!scale_decimal(d, prec, v)) {
+    r = false;
+    if (prec == 0) {
+      strcpy(buf, "inf");
+      return false;
+    }
+    prec--;
+  }
+  char digits[72];
+  int n = write_digits(digits, v, 10, false, prec + 1);
+  memcpy(buf, digits, n - prec);
+  buf += n - prec;
+  if (prec > 0 || alt)
+    *buf++ = '.';
+  strcpy(buf, digits + n - prec);
+  return r;
+}
+
+
+// Write d in exponential notation with prec decimals into buf.
+// Return false on overflow.
+static bool exp_body(char *buf, const Decimal &d, int prec, bool alt,
+		     bool upper, bool strip) {
+  uint64_t v = 0;
+  int exponent = 0;
+  if (!significant_digits(d, prec + 1, v, exponent)) {
+    strcpy(buf, "inf");
+    return false;
+  }
+  char digits[72];
+  write_digits(digits, v, 10, false, prec + 1);
+  char *bp = buf;
+  *bp++ = digits[0];
+  if (prec > 0 || alt)
+    *bp++ = '.';
+  strcpy(bp, digits + 1);
+  if (strip && !alt)
+    strip_zeros(buf);
+  buf += strlen(buf);
+  *buf++ = upper ? 'E' : 'e';
+  *buf++ = exponent < 0 ? '-' : '+';
+  write_digits(buf, abs(exponent), 10, false, 2);
+  return true;
+}
+
+
+// Skip literal text of the printf-style format and return the
+// conversion character, '\0' if there is none or if the width or
+// precision are given as arguments.
+static char format_conversion(const char *format) {
+  const char *fp = format;
+  for (; *fp != '\0'; ++fp) {
+    if (*fp == '%') {
+      if (fp[1] != '%')
 	break;
-    if (k < NUnits && strlen(UnitPref[k]) < strlen(newunit))
-      f2 = UnitFac[k];
+      ++fp;
+    }
   }
-  
-  return val * f1/f2;
+  if (*fp != '%')
+    return '\0';
+  for (++fp; *fp != '\0' && strchr("-0+ #.0123456789hlLqjzt", *fp) != NULL;
+       ++fp);
+  return *fp == '*' ? '\0' : *fp;
+}
+
+
+// Precision of the conversion of the printf-style format,
+// -1 if there is none.
+static int format_precision(const char *format) {
+  const char *fp = strchr(format, '.');
+  if (fp == NULL || format_conversion(format) == '\0')
+    return -1;
+  int prec = 0;
+  for (++fp; isdigit(*fp); ++fp)
+    prec = 10*prec + (*fp - '0');
+  return prec;
+}
+
+
+// Write value with snprintf() into str of size MaxVal according to
+// the printf-style format. Integer conversions are replaced by a
+// fixed-point conversion without decimals, since value is a double.
+static size_t print_double(char *str, double value, const char *format) {
+  char conv = format_conversion(format);
+  if (conv == '\0' || strchr("diuxXo", conv) == NULL)
+    return snprintf(str, Parameter::MaxVal, format, value);
+  char fmt[strlen(format) + 4];
+  char *cp = fmt;
+  const char *fp = format;
+  // literal text in front of the conversion:
+  for (; *fp != '%' || fp[1] == '%'; ++fp) {
+    if (*fp == '%')
+      *cp++ = *fp++;
+    *cp++ = *fp;
+  }
+  // flags and width:
+  for (*cp++ = *fp++; *fp != '\0' && strchr("-+ #0123456789", *fp) != NULL;
+       ++fp)
+    *cp++ = *fp;
+  // precision, length modifiers, and conversion:
+  for (; *fp != '\0' && strchr(".0123456789hlLqjzt", *fp) != NULL; ++fp);
+  ++fp;
+  strcpy(cp, ".0f");
+  strcat(cp, fp);
+  return snprintf(str, Parameter::MaxVal, fmt, value);
+}
+
+
+size_t Parameter::formatDecimal(char *str, bool negative, uint64_t mantissa,
+				int exponent, uint64_t num, uint64_t den,
+				const char *format) {
+  Decimal d = {mantissa, exponent, num, den};
+  bool ok = true;
+  char *sp = str;
+  char *end = str + MaxVal - 1;
+  const char *fp = format;
+  // literal text in front of the conversion:
+  for (; *fp != '\0' && sp < end; ++fp) {
+    if (*fp == '%') {
+      if (fp[1] != '%')
+	break;
+      ++fp;
+    }
+    *sp++ = *fp;
+  }
+  if (*fp == '%') {
+    ++fp;
+    // flags:
+    bool left = false;
+    bool zero = false;
+    char sign = '\0';
+    bool alt = false;
+    for (; *fp != '\0' && strchr("-0+ #", *fp) != NULL; ++fp) {
+      if (*fp == '-')
+	left = true;
+      else if (*fp == '0')
+	zero = true;
+      else if (*fp == '#')
+	alt = true;
+      else if (sign != '+')
+	sign = *fp;
+    }
+    // width and precision:
+    int width = 0;
+    for (; isdigit(*fp); ++fp)
+      width = 10*width + (*fp - '0');
+    int prec = -1;
+    if (*fp == '.') {
+      prec = 0;
+      for (++fp; isdigit(*fp); ++fp)
+	prec = 10*prec + (*fp - '0');
+    }
+    if (prec > 16)
+      prec = 16;
+    // length modifiers:
+    for (; *fp != '\0' && strchr("hlLqjzt", *fp) != NULL; ++fp);
+    char conv = *fp;
+    if (conv != '\0')
+      ++fp;
+    // digits:
+    char body[MaxVal];
+    uint64_t v = 0;
+    switch (conv) {
+    case 'f':
+    case 'F':
+      ok = fixed_body(body, d, prec < 0 ? 6 : prec, alt);
+      break;
+    case 'e':
+    case 'E':
+      ok = exp_body(body, d, prec < 0 ? 6 : prec, alt, conv == 'E', false);
+      break;
+    case 'g':
+    case 'G': {
+      int sig = prec < 0 ? 6 : prec == 0 ? 1 : prec;
+      int exponent = 0;
+      if (!significant_digits(d, sig, v, exponent)) {
+	strcpy(body, "inf");
+	ok = false;
+      }
+      else if (exponent < -4 || exponent >= sig)
+	ok = exp_body(body, d, sig - 1, alt, conv == 'G', true);
+      else {
+	ok = fixed_body(body, d, sig - 1 - exponent, alt);
+	if (!alt)
+	  strip_zeros(body);
+      }
+      break;
+    }
+    default:
+      ok = scale_decimal(d, 0, v);
+      if (!ok)
+	strcpy(body, "inf");
+      else if (conv == 'x' || conv == 'X' || conv == 'o')
+	write_digits(body, v, conv == 'o' ? 8 : 16, conv == 'X',
+		     prec < 0 ? 1 : prec);
+      else
+	write_digits(body, v, 10, false, prec < 0 ? 1 : prec);
+    }
+    if (negative)
+      sign = '-';
+    int n = strlen(body) + (sign != '\0' ? 1 : 0);
+    if (!left && !zero) {
+      for (; n < width && sp < end; n++)
+	*sp++ = ' ';
+    }
+    if (sign != '\0' && sp < end)
+      *sp++ = sign;
+    if (!left && zero) {
+      for (; n < width && sp < end; n++)
+	*sp++ = '0';
+    }
+    for (const char *bp = body; *bp != '\0' && sp < end; ++bp)
+      *sp++ = *bp;
+    for (; n < width && sp < end; n++)
+      *sp++ = ' ';
+  }
+  // literal text behind the conversion:
+  for (; *fp != '\0' && sp < end; ++fp) {
+    if (*fp == '%' && fp[1] == '%')
+      ++fp;
+    *sp++ = *fp;
+  }
+  *sp = '\0';
+  return ok ? sp - str : 0;
+}
+
+
+// Maximum number of 32-bit words of a binary fraction:
+static const int FracWords = 8;
+
+
+// Multiply the binary fraction frac/2^k stored in the nw words of frac
+// (least significant word first) by ten, remove the integer part from
+// frac, and return it as the next decimal digit.
+static int next_digit(uint32_t *frac, int nw, int k) {
+  uint32_t carry = 0;
+  for (int j=0; j<nw; j++) {
+    uint64_t p = uint64_t(frac[j])*10 + carry;
+    frac[j] = uint32_t(p);
+    carry = uint32_t(p >> 32);
+  }
+  int j = k/32;
+  int s = k%32;
+  uint64_t top = frac[j];
+  if (j + 1 < nw)
+    top |= uint64_t(frac[j + 1]) << 32;
+  frac[j] &= (uint32_t(1) << s) - 1;
+  for (++j; j<nw; j++)
+    frac[j] = 0;
+  return int(top >> s);
+}
+
+
+// True if the binary fraction frac/2^k is not zero.
+static bool nonzero_fraction(const uint32_t *frac, int nw) {
+  for (int j=0; j<nw; j++) {
+    if (frac[j] != 0)
+      return true;
+  }
+  return false;
+}
+
+
+// True if the number mantissa + frac/2^k is rounded up to the next
+// integer, with halfway cases rounded to even like printf().
+static bool round_up(uint64_t mantissa, const uint32_t *frac, int k) {
+  int j = (k - 1)/32;
+  uint32_t half = uint32_t(1) << ((k - 1)%32);
+  if ((frac[j] & half) == 0)
+    return false;
+  if ((frac[j] & (half - 1)) != 0)
+    return true;
+  for (int i=0; i<j; i++) {
+    if (frac[i] != 0)
+      return true;
+  }
+  return (mantissa & 1) == 1;
+}
+
+
+size_t Parameter::formatFloat(char *str, double value, const char *format) {
+  char conv = format_conversion(format);
+  int prec = format_precision(format);
+  double absval = value < 0 ? -value : value;
+  // absval = m*2^-k:
+  int e2 = 0;
+  double f = frexp(absval, &e2);
+  int k = 53 - e2;
+  // not a number, huge and tiny numbers, high precisions, and exotic formats:
+  if (value != value || absval >= 1e18 || k > 32*FracWords - 5 ||
+      prec > 16 || conv == '\0' || strchr("diufFeEgGxXo", conv) == NULL)
+    return print_double(str, value, format);
+  // number of decimals for fixed-point notation,
+  // or of significant digits otherwise:
+  bool fixed = (strchr("eEgG", conv) == NULL);
+  int ndigits = 0;
+  if (strchr("fF", conv) != NULL)
+    ndigits = prec < 0 ? 6 : prec;
+  else if (conv == 'e' || conv == 'E')
+    ndigits = (prec < 0 ? 6 : prec) + 1;
+  else if (conv == 'g' || conv == 'G')
+    ndigits = prec < 0 ? 6 : prec == 0 ? 1 : prec;
+  // integer part and binary fraction:
+  uint64_t m = uint64_t(ldexp(f, 53));
+  uint64_t mantissa = 0;
+  uint32_t frac[FracWords] = {0};
+  int nw = k > 0 ? (k + 4)/32 + 1 : 0;
+  if (k <= 0) {
+    // integers of at least 2^53 (absval < 1e18 < 2^60):
+    mantissa = m << -k;
+    m = 0;
+  }
+  else if (k < 64) {
+    mantissa = m >> k;
+    m &= (uint64_t(1) << k) - 1;
+  }
+  frac[0] = uint32_t(m);
+  frac[1] = uint32_t(m >> 32);
+  int exponent = 0;
+  int n = mantissa > 0 ? count_digits(mantissa) : 0;
+  if (fixed && n + ndigits > 18)
+    return print_double(str, value, format);
+  if (!fixed && n > ndigits) {
+    // round the integer part to ndigits significant digits:
+    uint64_t p = 1;
+    for (; n > ndigits; n--) {
+      p *= 10;
+      exponent++;
+    }
+    uint64_t r = mantissa % p;
+    mantissa /= p;
+    if (r > p/2 || (r == p/2 && (nonzero_fraction(frac, nw) ||
+				 (mantissa & 1) == 1)))
+      mantissa++;
+  }
+  else {
+    // the exact decimal digits of the fraction:
+    while (nonzero_fraction(frac, nw) &&
+	   (fixed ? -exponent < ndigits : n < ndigits)) {
+      mantissa = 10*mantissa + next_digit(frac, nw, k);
+      exponent--;
+      if (mantissa > 0)
+	n++;
+    }
+    // round once:
+    if (nonzero_fraction(frac, nw) && round_up(mantissa, frac, k))
+      mantissa++;
+  }
+  // value < 0 misses negative zero:
+  bool negative = (value < 0 || 1/value < 0);
+  n = formatDecimal(str, negative, mantissa, exponent, 1, 1, format);
+  if (n == 0)
+    n = print_double(str, value, format);
+  return n;
+}
+
+
+static char *skip_spaces(char *str) {
+  while (*str == ' ' || *str == '\t')
+    str++;
+  return str;
+}
+
+
+int Parameter::splitList(char *str, char **items, size_t n) {
+  char *sp = skip_spaces(str);
+  bool bracket = (*sp == '[');
+  if (bracket)
+    sp = skip_spaces(sp + 1);
+  if ((bracket && *sp == ']') || (!bracket && *sp == '\0'))
+    return *skip_spaces(bracket ? sp + 1 : sp) == '\0' ? 0 : -1;
+  size_t k = 0;
+  while (true) {
+    if (k >= n)
+      return -1;
+    sp = skip_spaces(sp);
+    char *item = sp;
+    char *end = sp;
+    if (*sp == '"' || *sp == '\'') {
+      char quote = *sp++;
+      item = sp;
+      while (*sp != quote && *sp != '\0')
+	sp++;
+      if (*sp != quote)
+	return -1;
+      end = sp;
+      sp = skip_spaces(sp + 1);
+    }
+    else {
+      while (*sp != ',' && *sp != ']' && *sp != '\0')
+	sp++;
+      end = sp;
+      while (end > item && (end[-1] == ' ' || end[-1] == '\t'))
+	end--;
+    }
+    char c = *sp;
+    *end = '\0';
+    items[k++] = item;
+    if (c == ',')
+      sp++;
+    else if (c == ']')
+      return bracket && *skip_spaces(sp + 1) == '\0' ? k : -1;
+    else if (c == '\0')
+      return bracket ? -1 : k;
+    else
+      return -1;
+  }
+}
+
+
+bool Parameter::appendItem(char *str, const char *item, bool separate) {
+  size_t n = strlen(str);
+  size_t m = strlen(item) + (separate ? 2 : 0);
+  // keep space for ", ...]" and the terminating zero:
+  if (n + m + 7 > MaxVal) {
+    strcpy(str + n, separate ? ", ..." : "...");
+    return false;
+  }
+  if (separate)
+    strcat(str, ", ");
+  strcat(str, item);
+  return true;
 }
 
 
@@ -373,18 +1453,31 @@ BaseStringParameter::BaseStringParameter(Menu &menu,
 					 size_t n, Modes mode) :
   Parameter(menu, name, n, mode),
   Selection(selection) {
+  setSelection(selection, n);
 }
 
 
-void BaseStringParameter::setSelection(const char **selection, size_t n) {
+void BaseStringParameter::setSelection(const char *const *selection,
+				       size_t n) {
   NSelection = n;
   Selection = selection;
+  indexSelection([this](size_t i, size_t j) {
+      return strcmp(Selection[i], Selection[j]) < 0; });
+}
+
+
+void BaseStringParameter::setNSelection(size_t n) {
+  setSelection(Selection, n);
 }
 
 
 int BaseStringParameter::checkSelection(const char *val) {
+  updateSelection();
   if (NSelection == 0)
     return 0;
+  if (SelectionIndex != NULL)
+    return searchSelection([this, val](size_t k) {
+	return strcmp(Selection[k], val); });
   for (size_t k=0; k<NSelection; k++)
     if (strcmp(Selection[k], val) == 0)
       return k;
@@ -393,6 +1486,7 @@ int BaseStringParameter::checkSelection(const char *val) {
 
 
 void BaseStringParameter::listSelection(Stream &stream) const {
+  const_cast<BaseStringParameter *>(this)->updateSelection();
   for (size_t k=0; k<NSelection; k++)
     stream.printf("  - %d) %s\n", k+1, Selection[k]);
 }
@@ -407,14 +1501,16 @@ ConstStringParameter::ConstStringParameter(Menu &menu, const char *name,
   BaseStringParameter(menu, name, mode),
   Value(str) {
   setRoles(ConstParameterRoles);
-  sprintf(TypeStr, "string %hu", strlen(str) + 1);
 }
 
 
 bool ConstStringParameter::setValue(const char *val) {
   if (val == 0)
     return false;
+  bool changed = (strcmp(Value, val) != 0);
   Value = val;
+  if (changed)
+    notifyValue();
   return true;
 }
 
@@ -425,11 +1521,186 @@ void ConstStringParameter::valueStr(char *str) const {
 }
 
 
+size_t ConstStringParameter::writeValue(Stream &stream) const {
+  return stream.print(Value);
+}
+
+
+void ConstStringParameter::typeStr(char *str) const {
+  sprintf(str, "string %hu", strlen(Value) + 1);
+}
+
+
+StringValueParameter::StringValueParameter(Menu &menu, const char *name,
+					   char *str, size_t size,
+					   const char **selection, size_t n,
+					   Modes mode) :
+  BaseStringParameter(menu, name, selection, n, mode),
+  Value(str),
+  Size(size),
+  Default(0),
+  Source(0) {
+}
+
+
+StringValueParameter::StringValueParameter(Menu &menu, const char *name,
+					   char *str, size_t size,
+					   Modes mode) :
+  BaseStringParameter(menu, name, mode),
+  Value(str),
+  Size(size),
+  Default(0),
+  Source(0) {
+}
+
+
+StringValueParameter::~StringValueParameter() {
+  delete Source;
+}
+
+
+void StringValueParameter::setSelectionProvider(SelectionProvider provider,
+						void *context, bool cache) {
+  if (provider == NULL) {
+    delete Source;
+    Source = 0;
+    setSelection(0, 0);
+    return;
+  }
+  if (Source == NULL)
+    Source = new SelectionSource<SelectionProvider>;
+  if (Source == NULL)
+    return;
+  Source->Provider = provider;
+  Source->Context = context;
+  Source->Cache = cache;
+  Source->Valid = false;
+}
+
+
+void StringValueParameter::invalidateSelection() {
+  if (Source != NULL)
+    Source->Valid = false;
+}
+
+
+void StringValueParameter::updateSelection() {
+  if (Source == NULL || (Source->Cache && Source->Valid))
+    return;
+  const char **selection = 0;
+  size_t n = Source->Provider(selection, Source->Context);
+  setSelection(selection, selection == NULL ? 0 : n);
+  Source->Valid = true;
+}
+
+
+bool StringValueParameter::setValue(const char *val) {
+  if (disabled(SetValue))
+    return false;
+  return parseValue(const_cast<char *>(val), false);
+}
+
+
+bool StringValueParameter::parseValue(char *val, bool selection) {
+  if (disabled(SetValue))
+    return true;
+  if (selection && NSelection > 0) {
+    if (strcmp(val, "q") == 0) {
+      strncpy(val, Value, MaxVal);
+      val[MaxVal-1] = '\0';
+    }
+    else {
+      char *end;
+      long i = strtol(val, &end, 10) - 1;
+      if (end == val || i < 0 || i >= (long)NSelection)
+	return false;
+      changeString(Value, Selection[i], Size);
+      strncpy(val, Selection[i], MaxVal);
+      val[MaxVal-1] = '\0';
+    }
+  }
+  else {
+    if (checkSelection(val) < 0)
+      return false;
+    changeString(Value, val, Size);
+  }
+  return true;
+}
+
+
+void StringValueParameter::valueStr(char *str) const {
+  size_t n = MaxVal < Size ? MaxVal : Size;
+  strncpy(str, Value, n);
+  str[n-1] = '\0';
+}
+
+
+bool StringValueParameter::getRaw(void *dest, size_t size) const {
+  if (size != Size)
+    return false;
+  memcpy(dest, Value, Size);
+  return true;
+}
+
+
+bool StringValueParameter::setRaw(const void *src, size_t size) {
+  if (size != Size || disabled(SetValue))
+    return false;
+  char str[Size];
+  memcpy(str, src, Size);
+  str[Size - 1] = '\0';
+  if (checkSelection(str) < 0)
+    return false;
+  changeString(Value, str, Size);
+  return true;
+}
+
+
+size_t StringValueParameter::writeValue(Stream &stream) const {
+  return stream.print(Value);
+}
+
+
+void StringValueParameter::typeStr(char *str) const {
+  sprintf(str, "string %d", (int)Size);
+}
+
+
+bool StringValueParameter::isDefault() const {
+  return Default == NULL || strncmp(Value, Default, Size - 1) == 0;
+}
+
+
+void StringValueParameter::resetDefaults() {
+  if (disabled(SetValue) || Default == NULL)
+    return;
+  changeString(Value, Default, Size);
+}
+
+
+int StringValueParameter::putValue(int addr, Storage &storage) const {
+  if (storage.put(addr, Value, Size))
+    return addr += Size;
+  else
+    return -1;
+}
+
+  
+int StringValueParameter::getValue(int addr, size_t size, Storage &storage) {
+  size_t n = size < Size ? size : Size;
+  char str[Size];
+  if (!storage.get(addr, str, n))
+    return -1;
+  str[n < Size ? n : Size - 1] = '\0';
+  changeString(Value, str, Size);
+  return addr += size;
+}
+
+
 BoolParameter::BoolParameter(Menu &menu, const char *name,
 			     bool val, Modes mode) :
   EnumParameter<bool>(menu, name, val,
 		      BoolEnums, YesNoStrings, 2, mode) {
-  strcpy(TypeStr, "boolean");
 }
 
 
@@ -437,5 +1708,4 @@ BoolPointerParameter::BoolPointerParameter(Menu &menu, const char *name,
 					   bool *val, Modes mode) :
   EnumPointerParameter<bool>(menu, name, val,
 			     BoolEnums, YesNoStrings, 2, mode) {
-  strcpy(TypeStr, "boolean");
 }
@@ -11,30 +11,49 @@
   calling value().  The *PointerParameter class just stores a pointer
   to the value, so that this external variable is updated immediately
   whenever it is configured - without the need to retrieve it from the
-  class instance.
+  class instance. Pointer parameters can also be bound to a Shared
+  value that can be safely read from interrupt service routines.
+  Both access the value via a pointer in a common base class (the
+  owned value is pointed to by the *Parameter class itself), so that
+  their code is compiled only once per type, and for strings only
+  once for all sizes.
 
   Via the constructors, parameter classes get their name and are added
-  to a Menu. Via the value() and the valueStr() member functions,
-  the current value can be obtained directly or as a string representation.
+  to a Menu. Like for the name, only pointers to format and unit
+  strings are stored, so pass literal strings. Via the value() and the
+  valueStr() member functions, the current value can be obtained
+  directly or as a string representation.
+
+  Each parameter keeps the value it was initialized with as its
+  default. For owned strings only a pointer to the initial string is
+  kept, so pass literal strings here as well. Pointer parameters
+  remember the value of the variable at construction.
 
   All Parameter-derived classes support selections. These are lists of
   valid values. When provided, values can be chosen from these
   selections and only values that are contained in selections are
   considered valid.
 
+  Number parameters take the features they support (unit, range,
+  selection) as a template argument, so that unused features
+  do not cost any code and memory.
+
   Classes:
   
   - Parameter: Base class for configurable parameters, i.e. name-value pairs.
   - BaseStringParameter: Base class for string values.
   - ConstStringParameter: A non-editable parameter whose value points to a static string.
+  - StringValueParameter: Base class for editable strings in a character array.
   - StringParameter: A parameter whose value is a string.
   - StringPointerParameter: A parameter whose value points to a string.
+  - EnumTable: Table of enum values and their names generated at compile time.
   - BaseEnumParameter: Base class for enum values, i.e. strings encoding integers.
   - EnumParameter: A parameter whose value is an integer that is represented as a string.
   - EnumPointerParameter: A parameter whose value points to an integer that is represented as a string.
   - BoolParameter: A parameter whose value is a boolean.
   - BoolPointerParameter: A parameter whose value points to a noolean.
   - BaseNumberParameter: Base class for numerical values with optional unit (integers and floats).
+  - NumberValueParameter: Base class for a single number with optional unit.
   - NumberParameter: A parameter whose value is a number with optional unit (any type of integer or float).
   - NumberPointerParameter: A parameter whose value points to a number with optional unit (any type of integer or float). 
 */
@@ -44,12 +63,26 @@
 
 
 #include <Action.h>
+#include <Shared.h>
 #include <Storage.h>
 
 
 class Menu;
 
 
+/* A function P supplying a selection at runtime, together with its
+   context and the state of the cached selection. Allocated only when
+   a provider is set, so that parameters without provider just hold
+   a pointer. */
+template<class P>
+struct SelectionSource {
+  P Provider;
+  void *Context;
+  bool Cache;
+  bool Valid;
+};
+
+
 /* Base class for configurable parameters, i.e. name-value pairs. */
 class Parameter : public Action {
 
@@ -59,6 +92,14 @@ class Parameter : public Action {
      and add it to menu. */
   Parameter(Menu &menu, const char *name, size_t n=0, Action::Modes mode=Action::User);
 
+  /* Free the index of the selection. */
+  virtual ~Parameter();
+
+  /* No copies, since the index of the selection is owned and
+     parameters are referenced by their menus. */
+  Parameter(const Parameter &) = delete;
+  Parameter &operator=(const Parameter &) = delete;
+
   /* Returns the unique identifier of this parameter
      or a number smaller than or equal to zero
      if identifier was not set yet. */
@@ -72,7 +113,9 @@ class Parameter : public Action {
      followed by its value to stream for display as a menu entry. */
   virtual void writeEntry(Stream &stream=Serial, size_t width=0) const;
   
-  /* Write the parameter's name and value to stream wih proper identation. */
+  /* Write the parameter's name and value to stream wih proper identation.
+     If roles contains NonDefault, nothing is written if the value
+     equals its default. */
   virtual void write(Stream &stream=Serial, unsigned int roles=AllRoles,
 		     size_t indent=0, size_t width=0) const;
   
@@ -81,23 +124,50 @@ class Parameter : public Action {
 
   /* Parse the string val and set the parameter accordingly.  If
      StreamOutput is enabled, report the new value together with name
-     on stream. */
-  virtual void set(const char *val, const char *name=0,
+     on stream. While the root menu stages a configuration, only
+     invalid values are reported.
+     Return false if val was not valid. */
+  virtual bool set(const char *val, const char *name=0,
 		   Stream &stream=Serial);
   
-  /* Write configuration with role StoragePut to addr in storage memory.
+  /* Write a record with key(), valueType(), valueSize() and the value
+     to addr in storage memory, if role StoragePut is enabled.
      Report errors and success on stream.
-     Returns address behind this configuration, -1 on error. */
+     Returns address behind this record, -1 on error. */
   virtual int put(int addr, Storage &storage,
 		  Stream &stream=Serial) const;
   
-  /* Read configuration with role StorageGet from addr in storage memory.
-     Only if setvalue is true set the parameter's value to content from storage.
+  /* Find the record matching key() in the records stored between
+     addr0 and addr1 in storage memory and set the parameter's value
+     accordingly, if role StorageGet is enabled.
+     Records with non-matching type or size are ignored.
      Report errors and success on stream.
-     Returns address behind this configuration, -1 on error. */
-  virtual int get(int addr, bool setvalue,
+     Returns 1 if the value was set, 0 if no matching record was found,
+     -1 on error. */
+  virtual int get(int addr0, int addr1,
 		  Storage &storage, Stream &stream=Serial);
 
+  /* Number of bytes put() writes to storage memory,
+     i.e. size of record header plus valueSize(). */
+  virtual size_t storageSize() const;
+
+  /* Update hash with key(), valueType() and valueSize(),
+     if the parameter is written to storage memory. */
+  virtual uint32_t fingerprint(uint32_t hash) const;
+
+  /* Number of bytes snapshot() writes, i.e. valueSize(). */
+  virtual size_t snapshotSize() const { return valueSize(); };
+
+  /* Write the value in its binary representation, as written by put()
+     but without the record header, to addr in storage memory.
+     Returns address behind the value, -1 on error. */
+  virtual int snapshot(int addr, Storage &storage) const;
+
+  /* Read the value written by snapshot() from addr in storage memory
+     and set the parameter's value accordingly, if SetValue is enabled.
+     Returns address behind the value, -1 on error. */
+  virtual int restore(int addr, Storage &storage);
+
   /* Transmit parameter using storage.
      Returns a negative number on error, zero if nothing can be
      transmitted, or a positive number, on success.*/
@@ -117,11 +187,17 @@ class Parameter : public Action {
      size MaxVal. */
   virtual void valueStr(char *str) const = 0;
 
+  /* Write the current value of this parameter to stream.
+     In contrast to valueStr(), the value is not limited to MaxVal
+     characters. Return the number of written characters.
+     Default implementation writes valueStr(). */
+  virtual size_t writeValue(Stream &stream) const;
+
   /* List selection of valid values. */
   virtual void listSelection(Stream &stream) const {};
 
   /* Change number of selection items to n. */
-  void setNSelection(size_t n);
+  virtual void setNSelection(size_t n);
 
   /* Return in str some instructions for interactive input,
      e.g. a valid range for numbers. Used for the prompt in execute().
@@ -131,37 +207,222 @@ class Parameter : public Action {
   /* Maximum size of string needed for valueStr() */
   static const size_t MaxVal = 64;
 
-  /* Convert val with oldunit to newunit. */
+  /* Convert val with oldunit to newunit.
+     Return val unchanged if the units are not compatible. */
   static float changeUnit(float val, const char *oldunit, const char *newunit);
+
+  /* Return in factor the factor converting values given in oldunit
+     to newunit, e.g. 0.001 for "ms" to "s" or 60 for "min" to "s".
+     Units are made of an optional SI prefix and a base unit, like
+     "s", "min", "h", "Hz", "V", "A", "W", "Ohm", "F", "m", "g",
+     "B", "bit", "dB", "deg", "rad", and "%".
+     Unknown base units are only compatible with themselves.
+     Return false if the units have different dimensions,
+     e.g. "Hz" and "s". */
+  static bool unitFactor(const char *oldunit, const char *newunit,
+			 float &factor);
+  static bool unitFactor(const char *oldunit, const char *newunit,
+			 double &factor);
+
+  /* Return in num and den the exact ratio num/den converting integer
+     values given in oldunit to newunit, e.g. 1/1000 for "ms" to "s".
+     Return false if the units are not compatible or the ratio
+     does not fit into 64-bit integers. */
+  static bool unitRatio(const char *oldunit, const char *newunit,
+			uint64_t &num, uint64_t &den);
+
+  /* Parse the number at the beginning of str into its sign,
+     its mantissa, and its power-of-ten exponent in a single pass
+     without any floating point arithmetic. The number is either a
+     decimal number with optional fraction and exponent, or a
+     hexadecimal ("0x") or binary ("0b") integer literal.
+     exact is set to false if non-zero digits of the integer part
+     do not fit into the mantissa and had to be dropped.
+     Return a pointer to the first character behind the number,
+     str if str does not start with a number. */
+  static const char *parseDecimal(const char *str, bool &negative,
+				  uint64_t &mantissa, int &exponent,
+				  bool &exact);
+
+  /* The number mantissa*10^exponent with sign negative, as parsed
+     by parseDecimal() from str, as a double. Only if the result
+     cannot be computed with a single rounding, str is parsed
+     by strtod(). */
+  static double decimalValue(const char *str, bool negative,
+			     uint64_t mantissa, int exponent);
+
+  /* Return in value mantissa*10^exponent*num/den rounded to the nearest
+     integer, computed in 64-bit integer arithmetic.
+     Return false on overflow. */
+  static bool scaleDecimal(uint64_t mantissa, int exponent,
+			   uint64_t num, uint64_t den, uint64_t &value);
+
+  /* Write the decimal number mantissa*10^exponent*num/den with sign
+     negative into str of maximum size MaxVal according to the
+     printf-style format. Supports the d, i, u, x, X, o, f, e, and g
+     conversions with flags, width, and precision in 64-bit integer
+     arithmetic. Halfway cases are rounded up.
+     Return the length of the string, zero if the number does not fit
+     into 64-bit integers with the requested precision. */
+  static size_t formatDecimal(char *str, bool negative, uint64_t mantissa,
+			      int exponent, uint64_t num, uint64_t den,
+			      const char *format);
+
+  /* Write value into str of maximum size MaxVal according to the
+     printf-style format. The exact binary value is rounded once to
+     the requested digits, with halfway cases rounded to even like
+     printf(), and formatted by formatDecimal(). Only for NaNs, huge
+     and tiny values, precisions above 16, more than 18 digits, and
+     other conversions snprintf() is used.
+     Return the length of the string. */
+  static size_t formatFloat(char *str, double value, const char *format);
+
+  /* Split the YAML flow sequence in str, like "[1, 2, 4, 8]", in place
+     into at most n items. The brackets are optional. Items can be
+     quoted by single or double quotes.
+     Return the number of items, -1 if str is not a valid sequence
+     or contains more than n items. */
+  static int splitList(char *str, char **items, size_t n);
+
+  /* Append item to the YAML flow sequence of maximum size MaxVal
+     in str, separated by a comma if separate.
+     If item does not fit, terminate the sequence by "..." and
+     return false. */
+  static bool appendItem(char *str, const char *item, bool separate);
+
+  /* Type tags of values stored in storage memory. */
+  enum ValueType : uint8_t {
+    NoValue = 0,
+    StringValue = 1,
+    EnumValue = 2,
+    BoolValue = 3,
+    IntegerValue = 4,
+    UnsignedValue = 5,
+    FloatValue = 6,
+    ArrayValue = 0x80   // flag for arrays of the above types
+  };
+
+  /* The type of the value as stored in storage memory. */
+  virtual ValueType valueType() const { return NoValue; };
+
+  /* The size of the value in bytes as stored in storage memory. */
+  virtual size_t valueSize() const { return 0; };
+
+  /* Copy the value in its binary representation, as described by
+     valueType() and valueSize(), into dest of size bytes.
+     Return false if size does not match valueSize(). */
+  virtual bool getRaw(void *dest, size_t size) const { return false; };
+
+  /* Set the value from its binary representation in src of size bytes,
+     as described by valueType() and valueSize(). Without any
+     conversion from a string, the value is validated like a parsed
+     one against the selection and the range of valid numbers.
+     Return false if size does not match valueSize(), if the value
+     is invalid, or if the parameter is disabled. */
+  virtual bool setRaw(const void *src, size_t size) { return false; };
+
+  /* Maximum size of string needed for typeStr(). */
+  static const size_t MaxType = 16;
+
+  /* Return in str of maximum size MaxType the type of the value
+     for infos in the interactive menu, e.g. "integer" or "string 32".
+     Default implementation returns an empty string. */
+  virtual void typeStr(char *str) const { *str = '\0'; };
+
+  /* A stable key identifying this parameter in storage memory.
+     This is a hash of the lower-case names of the parent menus
+     (excluding the root menu) and the parameter separated by '>'.
+     In contrast to identifier(), the key does not depend on the
+     position of the parameter in the menu tree. */
+  uint32_t key() const;
+
+  /* Size of a record header in storage memory
+     (key, type, and size of the value). */
+  static const size_t NRecord = 7;
+
+  /* Key marking the end of the records in storage memory. */
+  static const uint32_t EndKey = 0;
+
+  /* Write a record header with key, type and size
+     to addr in storage memory.
+     Returns address behind the header, -1 on error. */
+  static int putRecord(int addr, Storage &storage, uint32_t key,
+		       uint8_t type, uint16_t size);
+
+  /* Read the record header at addr in storage memory
+     into key, type and size.
+     Returns address behind the header, -1 on error or if the
+     end of the records has been reached. */
+  static int getRecord(int addr, Storage &storage, uint32_t &key,
+		       uint8_t &type, uint16_t &size);
+
+  /* Find the record with key in the records stored between addr0
+     and addr1 in storage memory and return its type and size.
+     Only the record headers are read.
+     Returns address of the record's value, -1 if not found. */
+  static int findRecord(uint32_t key, int addr0, int addr1,
+			Storage &storage, uint8_t &type, uint16_t &size);
   
   
  protected:
-
-  static const size_t NIdent = 4;
-
-  /* Generate an identifier for this Parameter.
-     This is used to mark entries in the storage memory. */
-  void makeIdentifier(char ident[NIdent]) const;
   
   /* Write value to addr in storage memory.
      Returns address behind this value, -1 on error. */
   virtual int putValue(int addr, Storage &storage) const { return addr; };
   
-  /* Read valuefrom addr in storage memory.
-     Only if setvalue is true set the action's value to content from Storage.
+  /* Read value of size bytes from addr in storage memory and
+     set the parameter's value accordingly.
      Returns address behind this value, -1 on error. */
-  virtual int getValue(int addr, bool setvalue, Storage &storage) { return addr; };
+  virtual int getValue(int addr, size_t size, Storage &storage) { return addr; };
+
+  /* Sort the indices of the items of the selection into
+     SelectionIndex, with less(i, j) returning whether item i comes
+     before item j. Selections with less than MinIndex items are
+     not indexed. */
+  template<class Less>
+  void indexSelection(Less less);
+
+  /* Binary search in the indexed selection. compare(k) returns a
+     negative number, zero, or a positive number if item k of the
+     selection is smaller, equal, or larger than the searched value.
+     Return the smallest index of a matching item, -1 if there is none. */
+  template<class Compare>
+  int searchSelection(Compare compare) const;
+
+  /* Publish the value of a shared variable and notify about
+     the change. */
+  void notifyValue();
+
+  /* While the root menu stages a configuration, copy the staged
+     value of size bytes into val and return true.
+     size must match valueSize(). */
+  bool getStaged(void *val, size_t size) const;
+
+  /* While the root menu stages a configuration, copy val of size
+     bytes into the staged value instead of the value of this
+     parameter and return true. size must match valueSize(). */
+  bool setStaged(const void *val, size_t size);
+
+  /* Assign val to value and notify about the change
+     if they differ. While the root menu stages a configuration,
+     val is assigned to the staged value. */
+  template<class V>
+  void changeValue(V &value, V val);
+
+  /* Copy the string str into value of size n and notify about the
+     change if they differ. While the root menu stages a
+     configuration, str is copied to the staged value. */
+  void changeString(char *value, const char *str, size_t n);
+
+  uint16_t NSelection;
 
   int ID;
 
-  size_t NSelection;
-  
-  static const size_t MaxType = 16;
-  char TypeStr[MaxType];
+  SharedValue *Publish;
+
+  static const size_t MinIndex = 8;
+  uint16_t *SelectionIndex;
   
-  static const int NUnits = 50;
-  static char UnitPref[NUnits][6];
-  static float UnitFac[NUnits];
   
 };
 
@@ -189,7 +450,10 @@ class BaseStringParameter : public Parameter {
   virtual bool setValue(const char *val) = 0;
 
   /* Provide a selection of n input values. */
-  void setSelection(const char **selection, size_t n);
+  void setSelection(const char *const *selection, size_t n);
+
+  /* Change number of selection items to n. */
+  virtual void setNSelection(size_t n);
 
   /* Check whether val matches a string of the selection. Return
      index of matching selection, 0 when there is no selection, and -1
@@ -199,10 +463,17 @@ class BaseStringParameter : public Parameter {
   /* List selection of valid values. */
   virtual void listSelection(Stream &stream) const;
 
+  /* The type of the value as stored in storage memory. */
+  virtual ValueType valueType() const { return StringValue; };
+
   
  protected:
 
-  const char **Selection;
+  /* Request the selection from a provider, if needed.
+     Default implementation does nothing. */
+  virtual void updateSelection() {};
+
+  const char *const *Selection;
 
   static const char *YesNoStrings[2];
   static const bool BoolEnums[2];
@@ -234,6 +505,12 @@ class ConstStringParameter : public BaseStringParameter {
   /* Return the current value of this parameter as a string. */
   virtual void valueStr(char *str) const;
 
+  /* Write the string to stream. */
+  virtual size_t writeValue(Stream &stream) const;
+
+  /* Return in str the type of the value. */
+  virtual void typeStr(char *str) const;
+
   
  protected:
 
@@ -242,30 +519,50 @@ class ConstStringParameter : public BaseStringParameter {
 };
 
 
-/* A parameter whose value is a string of size N. */
-template<int N>
-class StringParameter : public BaseStringParameter {
+/* Base class for editable strings in a character array.
+   The value is accessed via a pointer to the character array and its
+   size, so that strings of all sizes share the same code. */
+class StringValueParameter : public BaseStringParameter {
 
-  /* Parameter owning a character array. */
-  
  public:
   
-  /* Initialize parameter with identifying name, value, list of n
-     selections and add it to menu. */
-  StringParameter(Menu &menu, const char *name, const char str[N],
-		  const char **selection, size_t n,
-		  Action::Modes mode=Action::User);
-  
-  /* Initialize parameter with identifying name and value
-     and add it to menu. */
-  StringParameter(Menu &menu, const char *name, const char str[N],
-		  Action::Modes mode=Action::User);
+  /* Initialize parameter with identifying name, pointer str to
+     character array of size bytes, list of n selections, and add it
+     to menu. */
+  StringValueParameter(Menu &menu, const char *name, char *str, size_t size,
+		       const char **selection, size_t n, Modes mode);
+  
+  /* Initialize parameter with identifying name, pointer str to
+     character array of size bytes, and add it to menu. */
+  StringValueParameter(Menu &menu, const char *name, char *str, size_t size,
+		       Modes mode);
+
+  /* Free the selection provider. */
+  virtual ~StringValueParameter();
+
+  /* Function supplying a selection computed at runtime.
+     Set selection to an array of strings and return their number.
+     context is the pointer passed to setSelectionProvider(). */
+  typedef size_t (*SelectionProvider)(const char **&selection,
+				      void *context);
+
+  /* Let provider supply the selection whenever it is needed by
+     checkSelection() or listSelection(). If cache, the selection is
+     requested only once until invalidateSelection() is called.
+     Pass NULL to remove the provider. */
+  void setSelectionProvider(SelectionProvider provider, void *context=0,
+			    bool cache=true);
+
+  /* Request the selection from the provider again when it is
+     needed next time. */
+  void invalidateSelection();
 
   /* Return the string. */
   virtual const char* value() const { return Value; };
 
   /* Set the string to val.
-     Return true if val was a valid string or the parameter was disabled. */
+     Return true if val was a valid string, false if it was invalid
+     or the parameter was disabled. */
   virtual bool setValue(const char *val);
   
   /* Parse the string val and set the value of this parameter accordingly.
@@ -277,23 +574,80 @@ class StringParameter : public BaseStringParameter {
   /* Return the current value of this parameter as a string. */
   virtual void valueStr(char *str) const;
 
+  /* Write the string to stream. */
+  virtual size_t writeValue(Stream &stream) const;
+
+  /* The size of the value in bytes as stored in storage memory. */
+  virtual size_t valueSize() const { return Size; };
+
+  /* Copy the character array of valueSize() bytes into dest. */
+  virtual bool getRaw(void *dest, size_t size) const;
+
+  /* Set the string from the character array of valueSize() bytes in src. */
+  virtual bool setRaw(const void *src, size_t size);
+
+  /* Return in str the type of the value. */
+  virtual void typeStr(char *str) const;
+
+  /* The string the parameter was initialized with. */
+  const char *defaultValue() const { return Default; };
+
+  /* True if the string equals its default. */
+  virtual bool isDefault() const;
+
+  /* Set the string back to its default. */
+  virtual void resetDefaults();
+
   
  protected:
   
   /* Write value to addr in storage memory. */
   virtual int putValue(int addr, Storage &storage) const;
   
-  /* Read valuefrom addr in storage memory. */
-  virtual int getValue(int addr, bool setvalue, Storage &storage);
+  /* Read value of size bytes from addr in storage memory. */
+  virtual int getValue(int addr, size_t size, Storage &storage);
+
+  /* Request the selection from the provider, if needed. */
+  virtual void updateSelection();
+
+  char *Value;
+  size_t Size;
+  const char *Default;
+  SelectionSource<SelectionProvider> *Source;
+  
+};
+
+
+/* A parameter whose value is a string of size N. */
+template<int N>
+class StringParameter : public StringValueParameter {
+
+  /* Parameter owning a character array. */
+  
+ public:
+  
+  /* Initialize parameter with identifying name, value, list of n
+     selections and add it to menu. */
+  StringParameter(Menu &menu, const char *name, const char str[N],
+		  const char **selection, size_t n,
+		  Action::Modes mode=Action::User);
+  
+  /* Initialize parameter with identifying name and value
+     and add it to menu. */
+  StringParameter(Menu &menu, const char *name, const char str[N],
+		  Action::Modes mode=Action::User);
+
+  
+ protected:
 
-  char Value[N];
+  char String[N];
   
 };
 
 
 /* A parameter whose value points to a string of size N. */
 template<int N>
-class StringPointerParameter : public BaseStringParameter {
+class StringPointerParameter : public StringValueParameter {
 
   /* Parameter with a pointer to a character array. */
 
@@ -309,72 +663,257 @@ class StringPointerParameter : public BaseStringParameter {
      variable and add it to menu. */
   StringPointerParameter(Menu &menu, const char *name, char (*str)[N],
 			 Action::Modes mode=Action::User);
-
-  /* Return the string. */
-  virtual const char* value() const { return *Value; };
-
-  /* Set the string to val.
-     Return true if val was a valid string or the parameter was disabled. */
-  virtual bool setValue(const char *val) {
-    return parseValue(const_cast<char *>(val), false); };
   
-  /* Parse the string val and set the value of this parameter accordingly.
-     If selection, then val is the input in response to an offered
-     selection (i.e. it might be an index to the selection).
-     Return true if val was a valid string or the parameter was disabled. */
-  virtual bool parseValue(char *val, bool selection=false);
+  /* Initialize parameter with identifying name, pointer str to shared
+     value, list of n selections, and add it to menu. */
+  StringPointerParameter(Menu &menu, const char *name, Shared<char[N]> *str,
+			 const char **selection, size_t n,
+			 Action::Modes mode=Action::User);
+  
+  /* Initialize parameter with identifying name, pointer str to shared
+     value and add it to menu. */
+  StringPointerParameter(Menu &menu, const char *name, Shared<char[N]> *str,
+			 Action::Modes mode=Action::User);
+
+  /* Free the copy of the default string. */
+  virtual ~StringPointerParameter();
 
-  /* Return the current value of this parameter as a string. */
-  virtual void valueStr(char *str) const;
 
-  
  protected:
+
+  /* Copy the current string as the default string. */
+  void copyDefault();
   
-  /* Write value to addr in storage memory. */
-  virtual int putValue(int addr, Storage &storage) const;
+};
+
+
+/* Name of an enum value of type T for an EnumTable. */
+template<class T>
+struct EnumName {
+  T Value;
+  const char *Name;
+};
+
+
+/* Interface to the lookup functions of an EnumTable. */
+template<class T>
+class EnumLookup {
+
+ public:
+
+  /* Return the index of the enum value val, -1 if there is none. */
+  virtual int index(T val) const = 0;
+
+  /* Return the index of the enum with name str
+     (case insensitive), -1 if there is none. */
+  virtual int find(const char *str) const = 0;
+
+  /* FNV-1a hash of the lower-case characters of str. */
+  static constexpr uint32_t hash(const char *str) {
+    uint32_t h = 2166136261UL;
+    for (; *str != '\0'; str++) {
+      char c = *str;
+      if (c >= 'A' && c <= 'Z')
+	c += 'a' - 'A';
+      h = (h ^ uint8_t(c)) * 16777619UL;
+    }
+    return h;
+  };
   
-  /* Read valuefrom addr in storage memory. */
-  virtual int getValue(int addr, bool setvalue, Storage &storage);
+};
+
 
-  char (*Value)[N];
+/* Table of N enum values of type T and their names that is generated
+   at compile time. Define it as a constexpr, for example
+   constexpr EnumTable<Speed, 3> SpeedTable({{Speed::Low, "low"},
+                                             {Speed::Medium, "medium"},
+                                             {Speed::High, "high"}});
+   and pass it to an EnumParameter.
+   Names are found via a hash table of their case-folded hashes,
+   and enum values via a direct index if they are dense. */
+template<class T, size_t N>
+class EnumTable : public EnumLookup<T> {
+
+  static_assert(N > 0 && N < 255, "EnumTable needs 1 to 254 enums");
+
+ public:
+
+  /* Generate the table from the enum values and names. */
+  constexpr EnumTable(const EnumName<T> (&names)[N]) {
+    for (size_t i=0; i<N; i++) {
+      Enums[i] = names[i].Value;
+      Names[i] = names[i].Name;
+      Hashes[i] = EnumLookup<T>::hash(names[i].Name);
+      size_t s = Hashes[i] & (NSlots - 1);
+      while (Slots[s] != 0)
+	s = (s + 1) & (NSlots - 1);
+      Slots[s] = i + 1;
+      if (long(Enums[i]) < long(Min) || i == 0)
+	Min = Enums[i];
+    }
+    Dense = true;
+    for (size_t i=0; i<N; i++) {
+      long k = long(Enums[i]) - long(Min);
+      if (k >= long(N) || Order[k] != 0) {
+	Dense = false;
+	break;
+      }
+      Order[k] = i + 1;
+    }
+  };
+
+  /* Return the index of the enum value val, -1 if there is none. */
+  virtual int index(T val) const {
+    if (Dense) {
+      long k = long(val) - long(Min);
+      return k >= 0 && k < long(N) ? Order[k] - 1 : -1;
+    }
+    for (size_t i=0; i<N; i++) {
+      if (Enums[i] == val)
+	return i;
+    }
+    return -1;
+  };
+
+  /* Return the index of the enum with name str
+     (case insensitive), -1 if there is none. */
+  virtual int find(const char *str) const {
+    uint32_t h = EnumLookup<T>::hash(str);
+    for (size_t s = h & (NSlots - 1); Slots[s] != 0;
+	 s = (s + 1) & (NSlots - 1)) {
+      int i = Slots[s] - 1;
+      if (Hashes[i] == h && strcasecmp(Names[i], str) == 0)
+	return i;
+    }
+    return -1;
+  };
+
+  /* Smallest power of two with at least twice as many slots as enums. */
+  static constexpr size_t NSlots = N <= 2 ? 4 : N <= 4 ? 8 : N <= 8 ? 16 :
+    N <= 16 ? 32 : N <= 32 ? 64 : N <= 64 ? 128 : N <= 128 ? 256 : 512;
+
+  T Enums[N] = {};
+  const char *Names[N] = {};
+  uint32_t Hashes[N] = {};
+  uint8_t Slots[NSlots] = {};
+  uint8_t Order[N] = {};
+  T Min = T();
+  bool Dense = false;
   
 };
 
 
-/* Base class for enum values, i.e. strings encoding integers of type T. */
+/* Base class for enum values, i.e. strings encoding integers of type T.
+   The value is accessed via a pointer, so that owned and pointer
+   parameters share the same code. */
 template<class T>
 class BaseEnumParameter : public BaseStringParameter {
   
  public:
   
-  /* Initialize parameter with identifying name, list of n enum values
-     and coresponding string representations, and add it to menu. */
-  BaseEnumParameter(Menu &menu, const char *name,
+  /* Initialize parameter with identifying name, pointer to value,
+     list of n enum values and coresponding string representations,
+     and add it to menu. */
+  BaseEnumParameter(Menu &menu, const char *name, T *val,
 		    const T *enums, const char **selection, size_t n,
 		    Modes mode);
+  
+  /* Initialize parameter with identifying name, pointer to value,
+     table of enum values and their names, and add it to menu. */
+  template<size_t N>
+  BaseEnumParameter(Menu &menu, const char *name, T *val,
+		    const EnumTable<T, N> &table, Modes mode);
 
   /* Provide a selection of n enums with corresponding string
      representations. */
-  void setSelection(const T *enums, const char **selection, size_t n);
+  void setSelection(const T *enums, const char *const *selection, size_t n);
+
+  /* Provide the enums and their names from table.
+     Only a pointer to table is stored. */
+  template<size_t N>
+  void setSelection(const EnumTable<T, N> &table);
+
+  /* Change number of selection items to n. */
+  virtual void setNSelection(size_t n);
 
   /* Check whether val matches a string of the selection. Return
      corresponding enum value or -1 if not found. */
   int checkSelection(const char *val);
+
+  /* Return the enum string. */
+  virtual const char* value() const;
+
+  /* Set the enum to val.
+     Return true if val was a valid string, false if it was invalid
+     or the parameter was disabled. */
+  virtual bool setValue(const char *val);
   
   /* Return the enum value. */
-  virtual T enumValue() const = 0;
+  T enumValue() const { return *Value; };
 
   /* Set the enum to val.
      Return false if the parameter was disabled. */
-  virtual bool setEnumValue(T val) = 0;
+  bool setEnumValue(T val);
 
   /* Return string representation of enum value. */
   const char *enumStr(T val) const;
+  
+  /* Parse the string val and set the value of this parameter accordingly.
+     If selection, then val is the input in response to an offered
+     selection (i.e. it might be an index to the selection).
+     Return true if val was a valid string or the parameter was disabled. */
+  virtual bool parseValue(char *val, bool selection=false);
+
+  /* Return the current value of this parameter as a string. */
+  virtual void valueStr(char *str) const;
+
+  /* Write the enum string to stream. */
+  virtual size_t writeValue(Stream &stream) const;
+
+  /* The type of the value as stored in storage memory. */
+  virtual Parameter::ValueType valueType() const;
+
+  /* The size of the value in bytes as stored in storage memory. */
+  virtual size_t valueSize() const { return sizeof(T); };
+
+  /* Copy the enum value into dest. */
+  virtual bool getRaw(void *dest, size_t size) const;
+
+  /* Set the enum value from src, if it is one of the enums. */
+  virtual bool setRaw(const void *src, size_t size);
+
+  /* Return in str the type of the value. */
+  virtual void typeStr(char *str) const;
+
+  /* The enum value the parameter was initialized with. */
+  T defaultValue() const { return Default; };
+
+  /* True if the enum value equals its default. */
+  virtual bool isDefault() const { return *Value == Default; };
+
+  /* Set the enum value back to its default. */
+  virtual void resetDefaults();
 
   
  protected:
+  
+  /* Write value to addr in storage memory. */
+  virtual int putValue(int addr, Storage &storage) const;
+  
+  /* Read value of size bytes from addr in storage memory. */
+  virtual int getValue(int addr, size_t size, Storage &storage);
+
+  /* Return the index of the enum value val, -1 if there is none. */
+  int enumIndex(T val) const;
+
+  /* Return the index of the enum with name val (case insensitive),
+     -1 if there is none. */
+  int nameIndex(const char *val) const;
 
+  T *Value;
+  T Default;
   const T *Enums;
+  const EnumLookup<T> *Lookup;
   
 };
 
@@ -392,39 +931,17 @@ class EnumParameter : public BaseEnumParameter<T> {
 		const T *enums, const char **selection, size_t n,
 		Action::Modes mode=Action::User);
 
-  /* Return the enum string. */
-  virtual const char* value() const;
-
-  /* Set the enum to val.
-     Return true if val was a valid string or the parameter was disabled. */
-  virtual bool setValue(const char *val);
-  
-  /* Return the enum value. */
-  virtual T enumValue() const { return Value; };
-
-  /* Set the enum to val.
-     Return false if the parameter was disabled. */
-  virtual bool setEnumValue(T val);
-  
-  /* Parse the string val and set the value of this parameter accordingly.
-     If selection, then val is the input in response to an offered
-     selection (i.e. it might be an index to the selection).
-     Return true if val was a valid string or the parameter was disabled. */
-  virtual bool parseValue(char *val, bool selection=false);
-
-  /* Return the current value of this parameter as a string. */
-  virtual void valueStr(char *str) const;
+  /* Initialize parameter with identifying name, value, table of enum
+     values and their names, and add to menu. */
+  template<size_t N>
+  EnumParameter(Menu &menu, const char *name, T val,
+		const EnumTable<T, N> &table,
+		Action::Modes mode=Action::User);
 
   
  protected:
-  
-  /* Write value to addr in storage memory. */
-  virtual int putValue(int addr, Storage &storage) const;
-  
-  /* Read valuefrom addr in storage memory. */
-  virtual int getValue(int addr, bool setvalue, Storage &storage);
 
-  T Value;
+  T Enum;
   
 };
 
@@ -442,39 +959,19 @@ class EnumPointerParameter : public BaseEnumParameter<T> {
 		       const T *enums, const char **selection,
 		       size_t n, Action::Modes mode=Action::User);
 
-  /* Return the enum string. */
-  virtual const char* value() const;
-
-  /* Set the enum to val.
-     Return true if val was a valid string or the parameter was disabled. */
-  virtual bool setValue(const char *val);
-
-  /* Return the enum value. */
-  virtual T enumValue() const { return *Value; };
-
-  /* Set the enum to val.
-     Return false if the parameter was disabled. */
-  virtual bool setEnumValue(T val);
-  
-  /* Parse the string val and set the value of this parameter accordingly.
-     If selection, then val is the input in response to an offered
-     selection (i.e. it might be an index to the selection).
-     Return true if val was a valid string or the parameter was disabled. */
-  virtual bool parseValue(char *val, bool selection=false);
-
-  /* Return the current value of this parameter as a string. */
-  virtual void valueStr(char *str) const;
-
-  
- protected:
-  
-  /* Write value to addr in storage memory. */
-  virtual int putValue(int addr, Storage &storage) const;
-  
-  /* Read valuefrom addr in storage memory. */
-  virtual int getValue(int addr, bool setvalue, Storage &storage);
+  /* Initialize parameter with identifying name, pointer to value,
+     table of enum values and their names, and add to menu. */
+  template<size_t N>
+  EnumPointerParameter(Menu &menu, const char *name, T *val,
+		       const EnumTable<T, N> &table,
+		       Action::Modes mode=Action::User);
 
-  T *Value;
+  /* Initialize parameter with identifying name, shared value, list of
+     n enum values and coresponding string representations, and add to
+     menu. */
+  EnumPointerParameter(Menu &menu, const char *name, Shared<T> *val,
+		       const T *enums, const char **selection,
+		       size_t n, Action::Modes mode=Action::User);
   
 };
 
@@ -518,9 +1015,77 @@ class BoolPointerParameter : public EnumPointerParameter<bool> {
 };
 
 
-/* Base class for numerical values (integers and floats). */
+/* Features of number parameters that are selected at compile time
+   via the template argument F of the number parameter classes.
+   Code and data of disabled features are not compiled in. */
+enum NumberFeatures : unsigned {
+  NumberUnits = 1,      // numbers can have a unit
+  NumberRange = 2,      // numbers are checked against minimum and maximum
+  NumberSelection = 4,  // numbers are checked against a selection
+  NumberAllFeatures = NumberUnits | NumberRange | NumberSelection
+};
+
+
+/* Data of number parameters with units. Empty if disabled. */
+template<class T, bool Enabled>
+struct NumberUnitData {
+};
+
+/* Cached factor converting from Unit to OutUnit: OutFactor for
+   floating point types, the exact ratio OutNum/OutDen for integer
+   types (both zero if the ratio needs more than 32 bits). */
+template<class T, bool Integral=std::is_integral_v<T>>
+struct NumberUnitFactor {
+  std::conditional_t<std::is_same_v<T, double>, double, float> OutFactor = 1.0;
+};
+
+template<class T>
+struct NumberUnitFactor<T, true> {
+  uint32_t OutNum = 1;
+  uint32_t OutDen = 1;
+};
+
+template<class T>
+struct NumberUnitData<T, true> : NumberUnitFactor<T> {
+  const char *Unit = "";
+  const char *OutUnit = "";
+};
+
+
+/* Data of number parameters with range checks. Empty if disabled. */
+template<class T, bool Enabled>
+struct NumberRangeData {
+};
+
+template<class T>
+struct NumberRangeData<T, true> {
+  T Minimum = 0;
+  T Maximum = 0;
+  bool CheckMin = false;
+  bool CheckMax = false;
+};
+
+
+/* Data of number parameters with selections. Empty if disabled. */
+template<class T, bool Enabled>
+struct NumberSelectionData {
+};
+
 template<class T>
-class BaseNumberParameter : public Parameter {
+struct NumberSelectionData<T, true> {
+  const T *Selection = 0;
+  SelectionSource<size_t (*)(const T *&selection, void *context)> *Source = 0;
+};
+
+
+/* Base class for numerical values (integers and floats).
+   F selects the NumberFeatures that are supported. */
+template<class T, unsigned F=NumberAllFeatures>
+class BaseNumberParameter :
+  public Parameter,
+  protected NumberUnitData<T, (F & NumberUnits) != 0>,
+  protected NumberSelectionData<T, (F & NumberSelection) != 0>,
+  protected NumberRangeData<T, (F & NumberRange) != 0> {
   
  public:
   
@@ -537,25 +1102,33 @@ class BaseNumberParameter : public Parameter {
 		      T minimu, T maximum, const char *format,
 		      const char *unit, const char *outunit, Modes mode);
 
+  /* Free the selection provider. */
+  virtual ~BaseNumberParameter();
+
   /* The format string for formatting a number. */
   const char *format() const { return Format; };
 
   /* Set the format string to format.  If the number has a unit, then
      this is a format for a float, irrespective of the type of the
-     number. Without a unit this is a format for the type of the number. */
+     number. Without a unit this is a format for the type of the number.
+     Integer types are formatted in 64-bit integer arithmetic,
+     so that the length modifiers of the format do not matter.
+     Warning: only a pointer to format is stored. */
   void setFormat(const char *format);
 
   /* The unit string of the internal unit of the value, i.e. value(). */
-  const char *unit() const { return Unit; };
+  const char *unit() const;
 
-  /* Set the internal unit string to unit. */
+  /* Set the internal unit string to unit.
+     Warning: only a pointer to unit is stored. */
   void setUnit(const char *unit);
 
   /* The unit string used for string representations of the value,
      i.e. valueStr(). */
-  const char *outunit() const { return OutUnit; };
+  const char *outunit() const;
 
-  /* Set the unit string for the string representation of the value to unit. */
+  /* Set the unit string for the string representation of the value to unit.
+     Warning: only a pointer to unit is stored. */
   void setOutUnit(const char *unit);
 
   /* Set special value that is encoded as a string. 
@@ -566,10 +1139,29 @@ class BaseNumberParameter : public Parameter {
      If provided, only numbers in this list are valid inputs. */
   void setSelection(const T *selection, size_t n);
 
-  /* Check whether val matches a selection.
-     Return index of matching selection, 0 when there is no selection,
-     and -1 if no match was found. */
-  int checkSelection(T val);
+  /* Change number of selection items to n. */
+  virtual void setNSelection(size_t n);
+
+  /* Function supplying a selection computed at runtime.
+     Set selection to an array of numbers and return their number.
+     context is the pointer passed to setSelectionProvider(). */
+  typedef size_t (*SelectionProvider)(const T *&selection, void *context);
+
+  /* Let provider supply the selection whenever it is needed by
+     checkSelection() or listSelection(). If cache, the selection is
+     requested only once until invalidateSelection() is called.
+     Pass NULL to remove the provider. */
+  void setSelectionProvider(SelectionProvider provider, void *context=0,
+			    bool cache=true);
+
+  /* Request the selection from the provider again when it is
+     needed next time. */
+  void invalidateSelection();
+
+  /* Check whether val matches a selection.
+     Return index of matching selection, 0 when there is no selection,
+     and -1 if no match was found. */
+  int checkSelection(T val);
 
   /* List selection of valid values. */
   virtual void listSelection(Stream &stream) const;
@@ -586,61 +1178,111 @@ class BaseNumberParameter : public Parameter {
   /* Check whether val is in range. Return -2 if it is smaller than
      minimum, return -1 if it is larger than maximum, return 1 if it
      is in range. */
-  int checkMinMax(float val);
+  int checkMinMax(T val);
 
   /* Return for val a properly formatted string of maximum size MaxVal
      with outUnit appended.
      If use_special, replace special value by special string. */
   virtual void formatValue(T val, char *str, bool use_special=true) const;
 
-  
- protected:
+  /* Convert val given in unit to the internal unit().
+     Integer types are converted exactly with integer arithmetic.
+     Return false if unit is not compatible with unit()
+     or the converted value does not fit into T. */
+  bool fromUnit(T &val, const char *unit) const;
+
+  /* Convert val given in the internal unit() to unit.
+     Integer types are converted exactly with integer arithmetic.
+     Return false if unit is not compatible with unit()
+     or the converted value does not fit into T. */
+  bool toUnit(T &val, const char *unit) const;
+
+  /* Parse the number with optional unit in str in a single pass and
+     return it converted to the internal unit() in val.
+     Numbers without unit are given in outunit().
+     Return false if str is not a number followed by nothing but a
+     compatible unit, or if the number does not fit into T. */
+  bool parseNumber(const char *str, T &val) const;
+
+  /* The type of the value as stored in storage memory. */
+  virtual Parameter::ValueType valueType() const;
+
+  /* The size of the value in bytes as stored in storage memory. */
+  virtual size_t valueSize() const { return sizeof(T); };
+
+  /* Return in str the type of the value. */
+  virtual void typeStr(char *str) const;
 
-  static const size_t MaxFmt = 16;
-  char Format[MaxFmt];
   
-  static const size_t MaxUnit = 16;
-  char Unit[MaxUnit];
-  char OutUnit[MaxUnit];
+ protected:
 
-  const T *Selection;
+  static constexpr bool HasUnits = (F & NumberUnits) != 0;
+  static constexpr bool HasRange = (F & NumberRange) != 0;
+  static constexpr bool HasSelection = (F & NumberSelection) != 0;
 
   T SpecialValue;
-  const char *SpecialStr;
+  const char *Format;
+
+  /* Request the selection from the provider, if needed. */
+  void updateSelection();
+
+  /* Convert the decimal number mantissa*10^exponent with sign
+     negative given in unit to the internal unit() and return it in val
+     (integer types only). Return false if unit is not compatible
+     with unit() or the converted value does not fit into T. */
+  bool fromDecimal(bool negative, uint64_t mantissa, int exponent,
+		   const char *unit, T &val) const;
 
-  bool CheckMin;
-  T Minimum;
+  /* Set val to the integer with sign negative and magnitude value.
+     Return false if it does not fit into T. */
+  static bool fitInteger(bool negative, uint64_t value, T &val);
 
-  bool CheckMax;
-  T Maximum;
+  /* Floating point type for unit conversions of floating point types. */
+  typedef std::conditional_t<std::is_same_v<T, double>, double, float> Real;
+
+  /* Factor converting values from Unit to OutUnit, for integer types
+     the exact ratio OutNum/OutDen.
+     One if any of the units is empty. If OutUnit is not
+     compatible with Unit, OutUnit is set to Unit. */
+  void setOutFactor();
+
+  /* Return in num and den the exact ratio converting values from
+     Unit to OutUnit (integer types only). */
+  void outRatio(uint64_t &num, uint64_t &den) const;
+
+  const char *SpecialStr;
   
 };
 
 
-/* A parameter whose value is a number with optional unit (any type of integer or float). */
-template<class T>
-class NumberParameter : public BaseNumberParameter<T> {
+/* Base class for a single number with optional unit
+   (any type of integer or float).
+   The value is accessed via a pointer, so that owned and pointer
+   parameters share the same code. */
+template<class T, unsigned F=NumberAllFeatures>
+class NumberValueParameter : public BaseNumberParameter<T, F> {
   
  public:
   
-  /* Initialize parameter with identifying name, value,
+  /* Initialize parameter with identifying name, pointer to value,
      format string, unit, and selection, and add it to menu. */
-  NumberParameter(Menu &menu, const char *name, T value,
-		  const char *format, const char *unit=0,
-		  const char *outunit=0, const T *selection=0,
-		  size_t n=0, Action::Modes mode=Action::User);
+  NumberValueParameter(Menu &menu, const char *name, T *value,
+		       const char *format, const char *unit,
+		       const char *outunit, const T *selection,
+		       size_t n, Action::Modes mode);
   
-  /* Initialize parameter with identifying name, value,
+  /* Initialize parameter with identifying name, pointer to value,
      minimum and maximum, format string, unit, and add it to menu. */
-  NumberParameter(Menu &menu, const char *name, T value,
-		  T minimum, T maximum, const char *format,
-		  const char *unit=0, const char *outunit=0,
-		  Action::Modes mode=Action::User);
+  NumberValueParameter(Menu &menu, const char *name, T *value,
+		       T minimum, T maximum, const char *format,
+		       const char *unit, const char *outunit,
+		       Action::Modes mode);
 
   /* Return the value of the number in its unit(). */
-  T value() const { return Value; };
+  T value() const { return *Value; };
 
-  /* Return the value of the number in an alternative unit. */
+  /* Return the value of the number in an alternative unit.
+     If unit is not compatible with unit(), return the value in unit(). */
   T value(const char *unit) const;
 
   /* Set the number to val.
@@ -651,7 +1293,8 @@ class NumberParameter : public BaseNumberParameter<T> {
   /* Set the number to val unit. The number is converted to the internal unit.
      If a selection was provided, then the number is only set,
      if it matches an element of the selection, after it was
-     converted to the internal unit. */
+     converted to the internal unit. Values in units not compatible
+     with unit() are ignored. */
   void setValue(T val, const char *unit);
   
   /* Parse the string val and set the value of this parameter accordingly.
@@ -662,10 +1305,22 @@ class NumberParameter : public BaseNumberParameter<T> {
 
   /* Return the current value of this parameter as a string */
   virtual void valueStr(char *str) const;
-  
-  /* Return for val a properly formatted string of maximum size MaxVal
-     with outUnit appended. */
-  virtual void formatValue(T val, char *str, bool use_special=true) const { BaseNumberParameter<T>::formatValue(val, str, use_special); };
+
+  /* Copy the number in its internal unit into dest. */
+  virtual bool getRaw(void *dest, size_t size) const;
+
+  /* Set the number from src given in its internal unit, if it
+     matches the selection and is within the valid range. */
+  virtual bool setRaw(const void *src, size_t size);
+
+  /* The number the parameter was initialized with. */
+  T defaultValue() const { return Default; };
+
+  /* True if the number equals its default. */
+  virtual bool isDefault() const { return *Value == Default; };
+
+  /* Set the number back to its default. */
+  virtual void resetDefaults();
   
   
  protected:
@@ -673,17 +1328,46 @@ class NumberParameter : public BaseNumberParameter<T> {
   /* Write value to addr in storage memory. */
   virtual int putValue(int addr, Storage &storage) const;
   
-  /* Read valuefrom addr in storage memory. */
-  virtual int getValue(int addr, bool setvalue, Storage &storage);
+  /* Read value of size bytes from addr in storage memory. */
+  virtual int getValue(int addr, size_t size, Storage &storage);
 
-  T Value;
+  T *Value;
+  T Default;
+  
+};
+
+
+/* A parameter whose value is a number with optional unit (any type of integer or float). */
+template<class T, unsigned F=NumberAllFeatures>
+class NumberParameter : public NumberValueParameter<T, F> {
+  
+ public:
+  
+  /* Initialize parameter with identifying name, value,
+     format string, unit, and selection, and add it to menu. */
+  NumberParameter(Menu &menu, const char *name, T value,
+		  const char *format, const char *unit=0,
+		  const char *outunit=0, const T *selection=0,
+		  size_t n=0, Action::Modes mode=Action::User);
+  
+  /* Initialize parameter with identifying name, value,
+     minimum and maximum, format string, unit, and add it to menu. */
+  NumberParameter(Menu &menu, const char *name, T value,
+		  T minimum, T maximum, const char *format,
+		  const char *unit=0, const char *outunit=0,
+		  Action::Modes mode=Action::User);
+  
+  
+ protected:
+
+  T Number;
   
 };
 
 
 /* A parameter whose value points to a number with optional unit (any type of integer or float). */
-template<class T>
-class NumberPointerParameter : public BaseNumberParameter<T> {
+template<class T, unsigned F=NumberAllFeatures>
+class NumberPointerParameter : public NumberValueParameter<T, F> {
   
  public:
   
@@ -700,138 +1384,90 @@ class NumberPointerParameter : public BaseNumberParameter<T> {
 			 T minimum, T maximum, const char *format,
 			 const char *unit=0, const char *outunit=0,
 			 Action::Modes mode=Action::User);
-
-  /* Return the value of the number. */
-  T value() const { return *Value; };
-
-  /* Return the value of the number in an alternative unit. */
-  T value(const char *unit) const;
-
-  /* Set the number to val.
-     If a selection was provided, then the number is only set,
-     if it matches an element of the selection. */
-  void setValue(T val);
-
-  /* Set the number to val unit. The number is converted to the internal unit.
-     If a selection was provided, then the number is only set,
-     if it matches an element of the selection, after it was
-     converted to the internal unit. */
-  void setValue(T val, const char *unit);
-  
-  /* Parse the string val and set the value of this parameter accordingly.
-     If selection, then val is the input in response to an offered
-     selection (i.e. it might be an index to the selection).
-     Return true if val was a valid string or the parameter was disabled. */
-  virtual bool parseValue(char *val, bool selection=false);
-
-  /* Return the current value of this parameter as a string */
-  virtual void valueStr(char *str) const;
-  
-  /* Return for val a properly formatted string of maximum size MaxVal
-     with outUnit appended. */
-  virtual void formatValue(T val, char *str, bool use_special=true) const { BaseNumberParameter<T>::formatValue(val, str, use_special); };
-  
   
- protected:
-  
-  /* Write value to addr in storage memory. */
-  virtual int putValue(int addr, Storage &storage) const;
+  /* Initialize parameter with identifying name, pointer to shared value,
+     format string, unit, and selection, and add it to menu. */
+  NumberPointerParameter(Menu &menu, const char *name, Shared<T> *value,
+			 const char *format, const char *unit=0,
+			 const char *outunit=0, const T *selection=0,
+			 size_t n=0, Action::Modes mode=Action::User);
   
-  /* Read valuefrom addr in storage memory. */
-  virtual int getValue(int addr, bool setvalue, Storage &storage);
-
-  T *Value;
+  /* Initialize parameter with identifying name, pointer to shared value,
+     minimum, maximum, format string, and unit, and add it to menu. */
+  NumberPointerParameter(Menu &menu, const char *name, Shared<T> *value,
+			 T minimum, T maximum, const char *format,
+			 const char *unit=0, const char *outunit=0,
+			 Action::Modes mode=Action::User);
   
 };
 
 
-template<int N>
-StringParameter<N>::StringParameter(Menu &menu, const char *name,
-				    const char str[N],
-				    const char **selection, size_t n,
-				    Action::Modes mode) :
-  BaseStringParameter(menu, name, selection, n, mode) {
-  strncpy(Value, str, N);
-  Value[N-1] = '\0';
-  sprintf(TypeStr, "string %d", N);
-}
-
-
-template<int N>
-StringParameter<N>::StringParameter(Menu &menu, const char *name,
-				    const char str[N], Action::Modes mode) :
-  BaseStringParameter(menu, name, mode) {
-  strncpy(Value, str, N);
-  Value[N-1] = '\0';
-  sprintf(TypeStr, "string %d", N);
+template<class Less>
+void Parameter::indexSelection(Less less) {
+  delete[] SelectionIndex;
+  SelectionIndex = NULL;
+  if (NSelection < MinIndex)
+    return;
+  SelectionIndex = new uint16_t[NSelection];
+  if (SelectionIndex == NULL)
+    return;
+  // stable insertion sort, done only once:
+  for (size_t k=0; k<NSelection; k++) {
+    size_t j = k;
+    for (; j>0 && less(k, SelectionIndex[j-1]); j--)
+      SelectionIndex[j] = SelectionIndex[j-1];
+    SelectionIndex[j] = k;
+  }
 }
 
 
-template<int N>
-bool StringParameter<N>::setValue(const char *val) {
-  if (this->disabled(Action::SetValue))
-    return false;
-  char str[N];
-  strncpy(str, val, N);
-  str[N - 1] = '\0';
-  return parseValue(str, false);
+template<class V>
+void Parameter::changeValue(V &value, V val) {
+  if (setStaged(&val, sizeof(V)))
+    return;
+  if (value == val)
+    return;
+  value = val;
+  notifyValue();
 }
 
 
-template<int N>
-bool StringParameter<N>::parseValue(char *val, bool selection) {
-  if (disabled(Action::SetValue))
-    return true;
-  if (selection && NSelection > 0) {
-    if (strcmp(val, "q") == 0) {
-      strncpy(val, Value, MaxVal);
-      val[MaxVal-1] = '\0';
-    }
-    else {
-      char *end;
-      long i = strtol(val, &end, 10) - 1;
-      if (end == val || i < 0 || i >= (long)NSelection)
-	return false;
-      strncpy(Value, Selection[i], N);
-      Value[N-1] = '\0';
-      strncpy(val, Selection[i], MaxVal);
-      val[MaxVal-1] = '\0';
-    }
-  }
-  else {
-    if (checkSelection(val) < 0)
-      return false;
-    strncpy(Value, val, N);
-    Value[N-1] = '\0';
+template<class Compare>
+int Parameter::searchSelection(Compare compare) const {
+  size_t lo = 0;
+  size_t hi = NSelection;
+  while (lo < hi) {
+    size_t mid = (lo + hi)/2;
+    if (compare(SelectionIndex[mid]) < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
   }
-  return true;
+  if (lo < NSelection && compare(SelectionIndex[lo]) == 0)
+    return SelectionIndex[lo];
+  return -1;
 }
 
 
 template<int N>
-void StringParameter<N>::valueStr(char *str) const {
-  int n = MaxVal < N ? MaxVal : N;
-  strncpy(str, Value, n);
-  str[n-1] = '\0';
+StringParameter<N>::StringParameter(Menu &menu, const char *name,
+				    const char str[N],
+				    const char **selection, size_t n,
+				    Action::Modes mode) :
+  StringValueParameter(menu, name, String, N, selection, n, mode) {
+  strncpy(String, str, N);
+  String[N-1] = '\0';
+  Default = str;
 }
 
 
 template<int N>
-int StringParameter<N>::putValue(int addr, Storage &storage) const {
-  if (storage.put(addr, Value))
-    return addr += N;
-  else
-    return -1;
-}
-
-  
-template<int N>
-int StringParameter<N>::getValue(int addr, bool setvalue, Storage &storage) {
-  if (setvalue) {
-    if (!storage.get(addr, Value))
-      return -1;
-  }
-  return addr += N;
+StringParameter<N>::StringParameter(Menu &menu, const char *name,
+				    const char str[N], Action::Modes mode) :
+  StringValueParameter(menu, name, String, N, mode) {
+  strncpy(String, str, N);
+  String[N-1] = '\0';
+  Default = str;
 }
 
 
@@ -841,9 +1477,8 @@ StringPointerParameter<N>::StringPointerParameter(Menu &menu,
 						  char (*str)[N],
 						  const char **selection,
 						  size_t n, Action::Modes mode) :
-  BaseStringParameter(menu, name, selection, n, mode),
-  Value(str) {
-  sprintf(TypeStr, "string %d", N);
+  StringValueParameter(menu, name, *str, N, selection, n, mode) {
+  copyDefault();
 }
 
 
@@ -852,180 +1487,196 @@ StringPointerParameter<N>::StringPointerParameter(Menu &menu,
 						  const char *name,
 						  char (*str)[N],
 						  Action::Modes mode) :
-  BaseStringParameter(menu, name, mode),
-  Value(str) {
-  sprintf(TypeStr, "string %d", N);
+  StringValueParameter(menu, name, *str, N, mode) {
+  copyDefault();
 }
 
 
 template<int N>
-bool StringPointerParameter<N>::parseValue(char *val, bool selection) {
-  if (disabled(Action::SetValue))
-    return true;
-  if (selection && NSelection > 0) {
-    if (strcmp(val, "q") == 0) {
-      strncpy(val, *Value, MaxVal);
-      val[MaxVal-1] = '\0';
-    }
-    else {
-      char *end;
-      long i = strtol(val, &end, 10) - 1;
-      if (end == val || i < 0 || i >= (long)NSelection)
-	return false;
-      else {
-	strncpy(*Value, Selection[i], N);
-	(*Value)[N-1] = '\0';
-	strncpy(val, Selection[i], MaxVal);
-	val[MaxVal-1] = '\0';
-      }
-    }
-  }
-  else {
-    if (checkSelection(val) < 0)
-      return false;
-    strncpy(*Value, val, N);
-    (*Value)[N-1] = '\0';
-  }
-  return true;
+StringPointerParameter<N>::StringPointerParameter(Menu &menu,
+						  const char *name,
+						  Shared<char[N]> *str,
+						  const char **selection,
+						  size_t n, Action::Modes mode) :
+  StringPointerParameter(menu, name, str->shadow(), selection, n, mode) {
+  Publish = str;
 }
 
 
 template<int N>
-void StringPointerParameter<N>::valueStr(char *str) const {
-  int n = MaxVal < N ? MaxVal : N;
-  strncpy(str, *Value, n);
-  str[n-1] = '\0';
+StringPointerParameter<N>::StringPointerParameter(Menu &menu,
+						  const char *name,
+						  Shared<char[N]> *str,
+						  Action::Modes mode) :
+  StringPointerParameter(menu, name, str->shadow(), mode) {
+  Publish = str;
 }
 
 
 template<int N>
-int StringPointerParameter<N>::putValue(int addr, Storage &storage) const {
-  if (storage.put(addr, *Value))
-    return addr += N;
-  else
-    return -1;
-  
+StringPointerParameter<N>::~StringPointerParameter() {
+  delete[] Default;
 }
 
-  
+
 template<int N>
-int StringPointerParameter<N>::getValue(int addr, bool setvalue,
-					Storage &storage) {
-  if (setvalue) {
-    if (!storage.get(addr, *Value))
-      return -1;
-  }
-  return addr += N;
+void StringPointerParameter<N>::copyDefault() {
+  char *str = new char[strlen(Value) + 1];
+  if (str != NULL)
+    strcpy(str, Value);
+  Default = str;
 }
 
 
 template<class T>
 BaseEnumParameter<T>::BaseEnumParameter(Menu &menu,
-					const char *name,
+					const char *name, T *val,
 					const T *enums,
 					const char **selection,
 					size_t n, Action::Modes mode) :
-  BaseStringParameter(menu, name, selection, n, mode),
-  Enums(enums) {
-  strcpy(TypeStr, "enum");
+  BaseStringParameter(menu, name, mode),
+  Value(val),
+  Enums(enums),
+  Lookup(0) {
+  setSelection(enums, selection, n);
+}
+
+
+template<class T>
+template<size_t N>
+BaseEnumParameter<T>::BaseEnumParameter(Menu &menu,
+					const char *name, T *val,
+					const EnumTable<T, N> &table,
+					Action::Modes mode) :
+  BaseStringParameter(menu, name, mode),
+  Value(val),
+  Enums(0),
+  Lookup(0) {
+  setSelection(table);
 }
 
 
 template<class T>
 void BaseEnumParameter<T>::setSelection(const T *enums,
-					const char **selection,
+					const char *const *selection,
 					size_t n) {
   NSelection = n;
   Selection = selection;
   Enums = enums;
+  Lookup = 0;
+  indexSelection([this](size_t i, size_t j) {
+      return strcasecmp(Selection[i], Selection[j]) < 0; });
 }
 
 
 template<class T>
-int BaseEnumParameter<T>::checkSelection(const char *val) {
-  char lval[strlen(val)+1];
-  for (size_t k=0; k<strlen(val)+1; k++)
-    lval[k] = tolower(val[k]);
-  for (size_t j=0; j<NSelection; j++) {
-    char cval[strlen(Selection[j])+1];
-    for (size_t k=0; k<strlen(Selection[j])+1; k++)
-      cval[k] = tolower(Selection[j][k]);
-    if (strcmp(cval, lval) == 0)
-      return int(Enums[j]);
-  }
-  return -1;
+template<size_t N>
+void BaseEnumParameter<T>::setSelection(const EnumTable<T, N> &table) {
+  NSelection = N;
+  Selection = table.Names;
+  Enums = table.Enums;
+  Lookup = &table;
+  delete[] SelectionIndex;
+  SelectionIndex = 0;
 }
 
 
 template<class T>
-const char *BaseEnumParameter<T>::enumStr(T val) const {
-  for (size_t j=0; j<this->NSelection; j++) {
-    if (val == Enums[j])
-      return Selection[j];
-  }
-  return Selection[0];
+void BaseEnumParameter<T>::setNSelection(size_t n) {
+  setSelection(Enums, Selection, n);
 }
 
 
 template<class T>
-EnumParameter<T>::EnumParameter(Menu &menu, const char *name,
-				T val, const T *enums,
-				const char **selection, size_t n,
-				Action::Modes mode) :
-  BaseEnumParameter<T>(menu, name, enums, selection, n, mode),
-  Value(val) {
+int BaseEnumParameter<T>::checkSelection(const char *val) {
+  int j = nameIndex(val);
+  return j < 0 ? -1 : int(Enums[j]);
+}
+
+
+template<class T>
+int BaseEnumParameter<T>::nameIndex(const char *val) const {
+  if (Lookup != NULL)
+    return Lookup->find(val);
+  if (SelectionIndex != NULL)
+    return searchSelection([this, val](size_t k) {
+	return strcasecmp(Selection[k], val); });
+  for (size_t j=0; j<NSelection; j++) {
+    if (strcasecmp(Selection[j], val) == 0)
+      return j;
+  }
+  return -1;
 }
 
 
 template<class T>
-const char* EnumParameter<T>::value() const {
-  return this->enumStr(Value);
+const char* BaseEnumParameter<T>::value() const {
+  return enumStr(*Value);
 }
 
 
 template<class T>
-bool EnumParameter<T>::setValue(const char *val) {
-  if (this->disabled(Action::SetValue))
+bool BaseEnumParameter<T>::setValue(const char *val) {
+  if (disabled(Action::SetValue))
     return false;
-  char str[Parameter::MaxVal];
-  strncpy(str, val, Parameter::MaxVal);
-  str[Parameter::MaxVal - 1] = '\0';
+  char str[MaxVal];
+  strncpy(str, val, MaxVal);
+  str[MaxVal - 1] = '\0';
   return parseValue(str, false);
 }
 
 
 template<class T>
-bool EnumParameter<T>::setEnumValue(T val) {
-  if (this->disabled(Action::SetValue))
+bool BaseEnumParameter<T>::setEnumValue(T val) {
+  if (disabled(Action::SetValue))
     return false;
-  Value = val;
+  changeValue(*Value, val);
   return true;
 }
 
+
+template<class T>
+const char *BaseEnumParameter<T>::enumStr(T val) const {
+  int j = enumIndex(val);
+  return Selection[j < 0 ? 0 : j];
+}
+
+
+template<class T>
+int BaseEnumParameter<T>::enumIndex(T val) const {
+  if (Lookup != NULL)
+    return Lookup->index(val);
+  for (size_t j=0; j<NSelection; j++) {
+    if (val == Enums[j])
+      return j;
+  }
+  return -1;
+}
+
   
 template<class T>
-bool EnumParameter<T>::parseValue(char *val, bool selection) {
+bool BaseEnumParameter<T>::parseValue(char *val, bool selection) {
   if (strlen(val) == 0)
     return true;
-  if (selection && this->NSelection > 0) {
+  if (selection && NSelection > 0) {
     if (strcmp(val, "q") == 0) {
-      strncpy(val, this->enumStr(Value), this->MaxVal);
-      val[this->MaxVal-1] = '\0';
+      strncpy(val, enumStr(*Value), MaxVal);
+      val[MaxVal-1] = '\0';
     }
     else {
       char *end;
       long i = strtol(val, &end, 10) - 1;
-      if (end == val || i < 0 || i >= (long)this->NSelection)
+      if (end == val || i < 0 || i >= (long)NSelection)
 	return false;
-      Value = this->Enums[i];
+      changeValue(*Value, Enums[i]);
       valueStr(val);
     }
   }
   else {
-    int ev = this->checkSelection(val);
-    if (ev < 0)
+    int j = nameIndex(val);
+    if (j < 0)
       return false;
-    Value = T(ev);
+    changeValue(*Value, Enums[j]);
     valueStr(val);
   }
   return true;
@@ -1033,127 +1684,148 @@ bool EnumParameter<T>::parseValue(char *val, bool selection) {
 
 
 template<class T>
-void EnumParameter<T>::valueStr(char *str) const {
-  const char *es = this->enumStr(Value);
-  strncpy(str, es, Parameter::MaxVal);
-  str[Parameter::MaxVal-1] = '\0';
+void BaseEnumParameter<T>::valueStr(char *str) const {
+  const char *es = enumStr(*Value);
+  strncpy(str, es, MaxVal);
+  str[MaxVal-1] = '\0';
 }
 
 
 template<class T>
-int EnumParameter<T>::putValue(int addr, Storage &storage) const {
-  if (storage.put(addr, Value))
-    return addr += sizeof(T);
-  else
-    return -1;
+size_t BaseEnumParameter<T>::writeValue(Stream &stream) const {
+  return stream.print(enumStr(*Value));
 }
 
-  
+
 template<class T>
-int EnumParameter<T>::getValue(int addr, bool setvalue,
-			       Storage &storage) {
-  if (setvalue) {
-    if (!storage.get(addr, Value))
-      return -1;
-  }
-  return addr += sizeof(T);
+bool BaseEnumParameter<T>::getRaw(void *dest, size_t size) const {
+  if (size != sizeof(T))
+    return false;
+  memcpy(dest, Value, sizeof(T));
+  return true;
 }
 
 
 template<class T>
-EnumPointerParameter<T>::EnumPointerParameter(Menu &menu,
-					      const char *name,
-					      T *val, const T *enums,
-					      const char **selection,
-					      size_t n,
-					      Action::Modes mode) :
-  BaseEnumParameter<T>(menu, name, enums, selection, n, mode),
-  Value(val) {
+bool BaseEnumParameter<T>::setRaw(const void *src, size_t size) {
+  if (size != sizeof(T) || disabled(Action::SetValue))
+    return false;
+  T val;
+  memcpy(&val, src, sizeof(T));
+  if (enumIndex(val) < 0)
+    return false;
+  changeValue(*Value, val);
+  return true;
 }
 
 
 template<class T>
-const char* EnumPointerParameter<T>::value() const {
-  return this->enumStr(*Value);
+Parameter::ValueType BaseEnumParameter<T>::valueType() const {
+  if constexpr (std::is_same_v<T, bool>)
+    return Parameter::BoolValue;
+  else
+    return Parameter::EnumValue;
 }
 
 
 template<class T>
-bool EnumPointerParameter<T>::setValue(const char *val) {
-  if (this->disabled(Action::SetValue))
-    return false;
-  return parseValue(const_cast<char *>(val), false);
+void BaseEnumParameter<T>::typeStr(char *str) const {
+  if constexpr (std::is_same_v<T, bool>)
+    strcpy(str, "boolean");
+  else
+    strcpy(str, "enum");
 }
 
 
 template<class T>
-bool EnumPointerParameter<T>::setEnumValue(T val) {
-  if (this->disabled(Action::SetValue))
-    return false;
-  *Value = val;
-  return true;
+int BaseEnumParameter<T>::putValue(int addr, Storage &storage) const {
+  if (storage.put(addr, *Value))
+    return addr += sizeof(T);
+  else
+    return -1;
 }
 
   
 template<class T>
-bool EnumPointerParameter<T>::parseValue(char *val, bool selection) {
-  if (strlen(val) == 0)
-    return true;
-  if (selection && this->NSelection > 0) {
-    if (strcmp(val, "q") == 0) {
-      strncpy(val, this->enumStr(*Value), this->MaxVal);
-      val[this->MaxVal-1] = '\0';
-    }
-    else {
-      char *end;
-      long i = strtol(val, &end, 10) - 1;
-      if (end == val || i < 0 || i >= (long)this->NSelection)
-	return false;
-      *Value = this->Enums[i];
-      valueStr(val);
-    }
-  }
-  else {
-    int ev = this->checkSelection(val);
-    if (ev < 0)
-      return false;
-    *Value = T(ev);
-    valueStr(val);
-  }
-  return true;
+int BaseEnumParameter<T>::getValue(int addr, size_t size,
+				   Storage &storage) {
+  T val;
+  if (!storage.get(addr, val))
+    return -1;
+  changeValue(*Value, val);
+  return addr += sizeof(T);
 }
 
 
 template<class T>
-void EnumPointerParameter<T>::valueStr(char *str) const {
-  const char *es = this->enumStr(*Value);
-  strncpy(str, es, Parameter::MaxVal);
-  str[Parameter::MaxVal-1] = '\0';
+void BaseEnumParameter<T>::resetDefaults() {
+  if (this->disabled(Action::SetValue))
+    return;
+  this->changeValue(*Value, Default);
 }
 
 
 template<class T>
-int EnumPointerParameter<T>::putValue(int addr, Storage &storage) const {
-  if (storage.put(addr, *Value))
-    return addr += sizeof(T);
-  else
-    return -1;
+EnumParameter<T>::EnumParameter(Menu &menu, const char *name,
+				T val, const T *enums,
+				const char **selection, size_t n,
+				Action::Modes mode) :
+  BaseEnumParameter<T>(menu, name, &Enum, enums, selection, n, mode),
+  Enum(val) {
+  this->Default = val;
 }
 
-  
+
 template<class T>
-int EnumPointerParameter<T>::getValue(int addr, bool setvalue,
-				      Storage &storage) {
-  if (setvalue) {
-    if (!storage.get(addr, *Value))
-      return -1;
-  }
-  return addr += sizeof(T);
+template<size_t N>
+EnumParameter<T>::EnumParameter(Menu &menu, const char *name,
+				T val, const EnumTable<T, N> &table,
+				Action::Modes mode) :
+  BaseEnumParameter<T>(menu, name, &Enum, table, mode),
+  Enum(val) {
+  this->Default = val;
 }
 
 
 template<class T>
-BaseNumberParameter<T>::BaseNumberParameter(Menu &menu,
+EnumPointerParameter<T>::EnumPointerParameter(Menu &menu,
+					      const char *name,
+					      T *val, const T *enums,
+					      const char **selection,
+					      size_t n,
+					      Action::Modes mode) :
+  BaseEnumParameter<T>(menu, name, val, enums, selection, n, mode) {
+  this->Default = *val;
+}
+
+
+template<class T>
+template<size_t N>
+EnumPointerParameter<T>::EnumPointerParameter(Menu &menu,
+					      const char *name,
+					      T *val,
+					      const EnumTable<T, N> &table,
+					      Action::Modes mode) :
+  BaseEnumParameter<T>(menu, name, val, table, mode) {
+  this->Default = *val;
+}
+
+
+template<class T>
+EnumPointerParameter<T>::EnumPointerParameter(Menu &menu,
+					      const char *name,
+					      Shared<T> *val, const T *enums,
+					      const char **selection,
+					      size_t n,
+					      Action::Modes mode) :
+  EnumPointerParameter(menu, name, val->shadow(), enums, selection,
+		       n, mode) {
+  this->Publish = val;
+}
+
+
+template<class T, unsigned F>
+BaseNumberParameter<T, F>::BaseNumberParameter(Menu &menu,
 					    const char *name,
 					    const char *format,
 					    const char *unit,
@@ -1161,30 +1833,25 @@ BaseNumberParameter<T>::BaseNumberParameter(Menu &menu,
 					    const T *selection,
 					    size_t n, Action::Modes mode) :
   Parameter(menu, name, n, mode),
-  Format(""),
-  Unit(""),
-  OutUnit(""),
-  Selection(selection),
   SpecialValue(0),
-  SpecialStr(NULL),
-  CheckMin(false),
-  Minimum(0),
-  CheckMax(false),
-  Maximum(0) {
-  setFormat(format);
-  setUnit(unit);
-  setOutUnit(outunit);
-  if (strlen(OutUnit) == 0)
-    setOutUnit(unit);
-  if constexpr (std::is_integral_v<T>)
-    strcpy(this->TypeStr, "integer");
+  Format(""),
+  SpecialStr(NULL) {
+  if constexpr (HasSelection)
+    setSelection(selection, n);
   else
-    strcpy(this->TypeStr, "float");
+    NSelection = 0;
+  setFormat(format);
+  if constexpr (HasUnits) {
+    setUnit(unit);
+    setOutUnit(outunit);
+    if (strlen(this->OutUnit) == 0)
+      setOutUnit(unit);
+  }
 }
 
 
-template<class T>
-BaseNumberParameter<T>::BaseNumberParameter(Menu &menu,
+template<class T, unsigned F>
+BaseNumberParameter<T, F>::BaseNumberParameter(Menu &menu,
 					    const char *name,
 					    T minimum, T maximum,
 					    const char *format,
@@ -1192,357 +1859,545 @@ BaseNumberParameter<T>::BaseNumberParameter(Menu &menu,
 					    const char *outunit,
 					    Action::Modes mode) :
   Parameter(menu, name, 0, mode),
-  Format(""),
-  Unit(""),
-  OutUnit(""),
-  Selection(0),
   SpecialValue(0),
-  SpecialStr(NULL),
-  CheckMin(true),
-  Minimum(minimum),
-  CheckMax(true),
-  Maximum(maximum) {
+  Format(""),
+  SpecialStr(NULL) {
+  setMinimum(minimum);
+  setMaximum(maximum);
   setFormat(format);
-  setUnit(unit);
-  setOutUnit(outunit);
-  if (strlen(OutUnit) == 0)
-    setOutUnit(unit);
-  if constexpr (std::is_integral_v<T>)
-    strcpy(this->TypeStr, "integer");
-  else
-    strcpy(this->TypeStr, "float");
+  if constexpr (HasUnits) {
+    setUnit(unit);
+    setOutUnit(outunit);
+    if (strlen(this->OutUnit) == 0)
+      setOutUnit(unit);
+  }
 }
 
 
-template<class T>
-void BaseNumberParameter<T>::setFormat(const char *format) {
-  strncpy(Format, format, MaxFmt);
-  Format[MaxFmt-1] = '\0';
+template<class T, unsigned F>
+BaseNumberParameter<T, F>::~BaseNumberParameter() {
+  if constexpr (HasSelection)
+    delete this->Source;
 }
 
 
-template<class T>
-void BaseNumberParameter<T>::setUnit(const char *unit) {
-  if (unit != NULL) {
-    strncpy(Unit, unit, MaxUnit);
-    Unit[MaxUnit-1] = '\0';
-  }
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::setFormat(const char *format) {
+  Format = format == NULL ? "" : format;
 }
 
 
-template<class T>
-void BaseNumberParameter<T>::setOutUnit(const char *unit) {
+template<class T, unsigned F>
+const char *BaseNumberParameter<T, F>::unit() const {
+  if constexpr (HasUnits)
+    return this->Unit;
+  else
+    return "";
+}
+
+
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::setUnit(const char *unit) {
+  static_assert(HasUnits, "number parameter without NumberUnits feature");
   if (unit != NULL) {
-    strncpy(OutUnit, unit, MaxUnit);
-    OutUnit[MaxUnit-1] = '\0';
+    this->Unit = unit;
+    setOutFactor();
   }
 }
 
 
-template<class T>
-void BaseNumberParameter<T>::setSpecial(T value, const char *str) {
-  SpecialValue = value;
-  SpecialStr = str;
+template<class T, unsigned F>
+const char *BaseNumberParameter<T, F>::outunit() const {
+  if constexpr (HasUnits)
+    return this->OutUnit;
+  else
+    return "";
 }
 
 
-template<class T>
-void BaseNumberParameter<T>::setSelection(const T *selection, size_t n) {
-  NSelection = n;
-  Selection = selection;
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::setOutUnit(const char *unit) {
+  static_assert(HasUnits, "number parameter without NumberUnits feature");
+  if (unit != NULL) {
+    this->OutUnit = unit;
+    setOutFactor();
+  }
 }
 
 
-template<class T>
-int BaseNumberParameter<T>::checkSelection(T val) {
-  if (NSelection == 0)
-    return 0;
-  for (size_t k=0; k<NSelection; k++)
-    if (abs(float(Selection[k]) - float(val)) < 1e-8)
-      return k;
-  return -1;
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::setOutFactor() {
+  static_assert(HasUnits, "number parameter without NumberUnits feature");
+  if constexpr (std::is_integral_v<T>) {
+    this->OutNum = 1;
+    this->OutDen = 1;
+    uint64_t num = 1;
+    uint64_t den = 1;
+    if (this->Unit[0] == '\0' || this->OutUnit[0] == '\0')
+      return;
+    if (!this->unitRatio(this->Unit, this->OutUnit, num, den))
+      this->OutUnit = this->Unit;
+    else if (num > UINT32_MAX || den > UINT32_MAX) {
+      // computed on demand by outRatio():
+      this->OutNum = 0;
+      this->OutDen = 0;
+    }
+    else {
+      this->OutNum = num;
+      this->OutDen = den;
+    }
+  }
+  else {
+    this->OutFactor = 1.0;
+    if (this->Unit[0] == '\0' || this->OutUnit[0] == '\0')
+      return;
+    if (!this->unitFactor(this->Unit, this->OutUnit, this->OutFactor)) {
+      this->OutUnit = this->Unit;
+      this->OutFactor = 1.0;
+    }
+  }
 }
 
 
-template<class T>
-void BaseNumberParameter<T>::listSelection(Stream &stream) const {
-  char str[MaxVal];
-  for (size_t k=0; k<NSelection; k++) {
-    formatValue(Selection[k], str);
-    stream.printf("  - %s\n", str);
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::outRatio(uint64_t &num, uint64_t &den) const {
+  num = this->OutNum;
+  den = this->OutDen;
+  if (den == 0 && !this->unitRatio(this->Unit, this->OutUnit, num, den)) {
+    num = 1;
+    den = 1;
   }
 }
 
 
-template<class T>
-void BaseNumberParameter<T>::instructions(char *str) const {
-  Parameter::instructions(str);
-  if (detailed()) {
-    strcat(str, ", ");
-    strcat(str, Unit);
+template<class T, unsigned F>
+bool BaseNumberParameter<T, F>::fromUnit(T &val, const char *unit) const {
+  if constexpr (!HasUnits)
+    return true;
+  else if (unit == 0 || unit[0] == '\0' || this->Unit[0] == '\0')
+    return true;
+  else if constexpr (std::is_integral_v<T>) {
+    bool negative = val < 0;
+    uint64_t value = negative ? uint64_t(0) - uint64_t(val) : uint64_t(val);
+    return fromDecimal(negative, value, 0, unit, val);
   }
-  char min_str[MaxVal];
-  char max_str[MaxVal];
-  if (NSelection == 0) {
-    if (CheckMin && CheckMax) {
-      formatValue(Minimum, min_str, false);    
-      formatValue(Maximum, max_str, false);
-      if (strlen(str) > 0)
-	strcat(str, ", ");
-      sprintf(str + strlen(str), "between %s and %s", min_str, max_str);
-    }
-    else if (CheckMin) {
-      formatValue(Minimum, min_str, false);    
-      if (strlen(str) > 0)
-	strcat(str, ", ");
-      sprintf(str + strlen(str), "greater than or equal to %s", min_str);
-    }
-    else if (CheckMax) {
-      formatValue(Maximum, max_str, false);    
-      if (strlen(str) > 0)
-	strcat(str, ", ");
-      sprintf(str + strlen(str), "less than or equal to %s", max_str);
+  else {
+    if (unit == this->OutUnit || strcmp(unit, this->OutUnit) == 0) {
+      val /= this->OutFactor;
+      return true;
     }
-  }
-  if (SpecialStr != NULL && strlen(SpecialStr) > 0) {
-    if (strlen(str) > 0)
-      strcat(str, ", ");
-    formatValue(SpecialValue, max_str, false);
-    sprintf(str + strlen(str), "or \"%s\" [%s]", SpecialStr, max_str);
+    Real factor = 1.0;
+    if (!this->unitFactor(unit, this->Unit, factor))
+      return false;
+    val *= factor;
+    return true;
   }
 }
 
 
-template<class T>
-void BaseNumberParameter<T>::setMinimum(T minimum) {
-  CheckMin = true;
-  Minimum = minimum;
+template<class T, unsigned F>
+bool BaseNumberParameter<T, F>::toUnit(T &val, const char *unit) const {
+  if constexpr (!HasUnits)
+    return true;
+  else if (unit == 0 || unit[0] == '\0' || this->Unit[0] == '\0')
+    return true;
+  else if constexpr (std::is_integral_v<T>) {
+    uint64_t num = 1;
+    uint64_t den = 1;
+    outRatio(num, den);
+    if (unit != this->OutUnit && strcmp(unit, this->OutUnit) != 0 &&
+	!this->unitRatio(this->Unit, unit, num, den))
+      return false;
+    bool negative = val < 0;
+    uint64_t value = negative ? uint64_t(0) - uint64_t(val) : uint64_t(val);
+    return this->scaleDecimal(value, 0, num, den, value) &&
+      fitInteger(negative, value, val);
+  }
+  else {
+    Real factor = 1.0;
+    if (!this->unitFactor(this->Unit, unit, factor))
+      return false;
+    val *= factor;
+    return true;
+  }
 }
 
 
-template<class T>
-void BaseNumberParameter<T>::setMaximum(T maximum) {
-  CheckMax = true;
-  Maximum = maximum;
+template<class T, unsigned F>
+bool BaseNumberParameter<T, F>::parseNumber(const char *str, T &val) const {
+  bool negative = false;
+  uint64_t mantissa = 0;
+  int exponent = 0;
+  bool exact = true;
+  const char *up = this->parseDecimal(str, negative, mantissa, exponent,
+				      exact);
+  if (up == str)
+    return false;
+  while (*up == ' ')
+    up++;
+  if (*up != '\0' && this->unit()[0] == '\0')
+    return false;
+  const char *unit = *up == '\0' ? this->outunit() : up;
+  if constexpr (std::is_integral_v<T>)
+    return exact && fromDecimal(negative, mantissa, exponent, unit, val);
+  else {
+    T nv = this->decimalValue(str, negative, mantissa, exponent);
+    if (!fromUnit(nv, unit))
+      return false;
+    val = nv;
+    return true;
+  }
 }
 
 
-template<class T>
-int BaseNumberParameter<T>::checkMinMax(float val) {
-  if (CheckMin && val < float(Minimum))
-    return -2;
-  if (CheckMax && val > float(Maximum))
-    return -1;
-  return 1;
+template<class T, unsigned F>
+bool BaseNumberParameter<T, F>::fromDecimal(bool negative, uint64_t mantissa,
+					 int exponent, const char *unit,
+					 T &val) const {
+  uint64_t num = 1;
+  uint64_t den = 1;
+  if constexpr (HasUnits) {
+    if (unit != 0 && unit[0] != '\0' && this->Unit[0] != '\0') {
+      if (unit == this->OutUnit || strcmp(unit, this->OutUnit) == 0)
+	outRatio(den, num);
+      else if (!this->unitRatio(unit, this->Unit, num, den))
+	return false;
+    }
+  }
+  uint64_t value = 0;
+  if (!this->scaleDecimal(mantissa, exponent, num, den, value))
+    return false;
+  return fitInteger(negative, value, val);
 }
 
 
-template<class T>
-void BaseNumberParameter<T>::formatValue(T val, char *str, bool use_special) const {
-  if (this->Unit != NULL && strlen(this->Unit) > 0) {
-    float value = this->changeUnit((float)val, this->Unit, this->OutUnit);
-    if (use_special && SpecialStr != NULL && strlen(SpecialStr) > 0 &&
-	value == SpecialValue)
-      strcpy(str, SpecialStr);
-    else {
-      sprintf(str, this->Format, value);
-      if (this->OutUnit != 0)
-	strcat(str, this->OutUnit);
-    }
+template<class T, unsigned F>
+bool BaseNumberParameter<T, F>::fitInteger(bool negative, uint64_t value,
+					T &val) {
+  if constexpr (std::is_signed_v<T>) {
+    uint64_t max = (uint64_t(1) << (8*sizeof(T) - 1)) - 1;
+    if (value > max + (negative ? 1 : 0))
+      return false;
+    if (negative && value > 0)
+      val = -T(value - 1) - 1;
+    else
+      val = T(value);
   }
   else {
-    if (use_special && SpecialStr != NULL && strlen(SpecialStr) > 0 &&
-	val == SpecialValue)
-      strcpy(str, SpecialStr);
-    else
-      sprintf(str, this->Format, val);
+    if (negative && value > 0)
+      return false;
+    if (value > uint64_t(T(~T(0))))
+      return false;
+    val = T(value);
   }
+  return true;
 }
 
 
-template<class T>
-NumberParameter<T>::NumberParameter(Menu &menu, const char *name,
-				    T number, const char *format,
-				    const char *unit,
-				    const char *outunit,
-				    const T *selection, size_t n,
-				    Action::Modes mode) :
-  BaseNumberParameter<T>(menu, name, format, unit, outunit,
-			 selection, n, mode),
-  Value(number) {
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::setSpecial(T value, const char *str) {
+  SpecialValue = value;
+  SpecialStr = str;
 }
 
 
-template<class T>
-NumberParameter<T>::NumberParameter(Menu &menu, const char *name,
-				    T number, T minimum, T maximum,
-				    const char *format,
-				    const char *unit,
-				    const char *outunit,
-				    Action::Modes mode) :
-  BaseNumberParameter<T>(menu, name, minimum, maximum, format,
-			 unit, outunit, mode),
-  Value(number) {
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::setSelection(const T *selection, size_t n) {
+  static_assert(HasSelection, "number parameter without NumberSelection feature");
+  NSelection = n;
+  this->Selection = selection;
+  this->indexSelection([this](size_t i, size_t j) {
+      return this->Selection[i] < this->Selection[j]; });
 }
 
 
-template<class T>
-T NumberParameter<T>::value(const char *unit) const {
-  float val = changeUnit((float)Value, this->Unit, unit);
-  return (T)val;
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::setNSelection(size_t n) {
+  if constexpr (HasSelection)
+    setSelection(this->Selection, n);
 }
 
 
-template<class T>
-void NumberParameter<T>::setValue(T val) {
-  if (this->checkSelection(val) < 0)
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::setSelectionProvider(SelectionProvider provider,
+						     void *context,
+						     bool cache) {
+  static_assert(HasSelection, "number parameter without NumberSelection feature");
+  if (provider == NULL) {
+    delete this->Source;
+    this->Source = 0;
+    setSelection(0, 0);
     return;
-  if (this->checkMinMax(val) < 0)
+  }
+  if (this->Source == NULL)
+    this->Source = new SelectionSource<SelectionProvider>;
+  if (this->Source == NULL)
     return;
-  Value = val;
+  this->Source->Provider = provider;
+  this->Source->Context = context;
+  this->Source->Cache = cache;
+  this->Source->Valid = false;
 }
 
 
-template<class T>
-void NumberParameter<T>::setValue(T val, const char *unit) {
-  float nv = changeUnit((float)val, unit, this->Unit);
-  if (this->checkSelection(val) < 0)
-    return;
-  if (this->checkMinMax(nv) < 0)
-    return;
-  Value = (T)nv;
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::invalidateSelection() {
+  if constexpr (HasSelection) {
+    if (this->Source != NULL)
+      this->Source->Valid = false;
+  }
 }
 
 
-template<class T>
-bool NumberParameter<T>::parseValue(char *val, bool selection) {
-  if (this->disabled(Action::SetValue))
-    return true;
-  if (strlen(val) == 0)
-    return true;
-  // when a selection was offered and 'q' was entered, keep the value:
-  if (selection && this->NSelection > 0 && strcmp(val, "q") == 0) {
-    valueStr(val);
-    return true;
-  }
-  if (this->SpecialStr != NULL && strlen(this->SpecialStr) > 0 &&
-      strcmp(val, this->SpecialStr) == 0) {
-    Value = this->SpecialValue;
-    return true;
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::updateSelection() {
+  if constexpr (HasSelection) {
+    if (this->Source == NULL ||
+	(this->Source->Cache && this->Source->Valid))
+      return;
+    const T *selection = 0;
+    size_t n = this->Source->Provider(selection, this->Source->Context);
+    setSelection(selection, selection == NULL ? 0 : n);
+    this->Source->Valid = true;
   }
-  float num = atof(val);
-  const char *up = val;
-  for (; *up != '\0' && (isdigit(*up) || *up == '+' || *up == '-' ||
-			   *up == '.' || *up == 'e'); ++up);
-  if (up == val)
-    return false;
-  char unit[this->MaxUnit] = "";
-  if (strlen(up) == 0 && strlen(this->OutUnit) > 0)
-    strncpy(unit, this->OutUnit, this->MaxUnit);
+}
+
+
+template<class T, unsigned F>
+int BaseNumberParameter<T, F>::checkSelection(T val) {
+  if constexpr (!HasSelection)
+    return 0;
   else {
-    strncpy(unit, up, this->MaxUnit);
-    unit[this->MaxUnit-1] = '\0';
+    updateSelection();
+    if (NSelection == 0)
+      return 0;
+    // same comparison for indexed and linear search:
+    auto compare = [this, val](size_t k) {
+      if constexpr (std::is_integral_v<T>)
+	return this->Selection[k] < val ? -1 : (this->Selection[k] > val ? 1 : 0);
+      else
+	return this->Selection[k] < val - 1e-8 ? -1 :
+	  (this->Selection[k] > val + 1e-8 ? 1 : 0);
+    };
+    if (this->SelectionIndex != NULL)
+      return this->searchSelection(compare);
+    for (size_t k=0; k<NSelection; k++) {
+      if (compare(k) == 0)
+	return k;
+    }
+    return -1;
   }
-  float nv = this->changeUnit(num, unit, this->Unit);
-  if (this->checkSelection(nv) < 0)
-    return false;
-  if (this->checkMinMax(nv) < 0)
-    return false;
-  Value = (T)nv;
-  return true;
 }
 
 
-template<class T>
-void NumberParameter<T>::valueStr(char *str) const {
-  formatValue(Value, str);
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::listSelection(Stream &stream) const {
+  if constexpr (HasSelection) {
+    const_cast<BaseNumberParameter<T, F> *>(this)->updateSelection();
+    char str[MaxVal];
+    for (size_t k=0; k<NSelection; k++) {
+      formatValue(this->Selection[k], str);
+      stream.printf("  - %s\n", str);
+    }
+  }
 }
 
 
-template<class T>
-int NumberParameter<T>::putValue(int addr, Storage &storage) const {
-  if (storage.put(addr, Value))
-    return addr += sizeof(T);
-  else
-    return -1;
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::instructions(char *str) const {
+  Parameter::instructions(str);
+  if (detailed()) {
+    strcat(str, ", ");
+    strcat(str, unit());
+  }
+  char min_str[MaxVal];
+  char max_str[MaxVal];
+  if constexpr (HasRange) {
+    if (NSelection == 0) {
+      if (this->CheckMin && this->CheckMax) {
+	formatValue(this->Minimum, min_str, false);    
+	formatValue(this->Maximum, max_str, false);
+	if (strlen(str) > 0)
+	  strcat(str, ", ");
+	sprintf(str + strlen(str), "between %s and %s", min_str, max_str);
+      }
+      else if (this->CheckMin) {
+	formatValue(this->Minimum, min_str, false);    
+	if (strlen(str) > 0)
+	  strcat(str, ", ");
+	sprintf(str + strlen(str), "greater than or equal to %s", min_str);
+      }
+      else if (this->CheckMax) {
+	formatValue(this->Maximum, max_str, false);    
+	if (strlen(str) > 0)
+	  strcat(str, ", ");
+	sprintf(str + strlen(str), "less than or equal to %s", max_str);
+      }
+    }
+  }
+  if (SpecialStr != NULL && strlen(SpecialStr) > 0) {
+    if (strlen(str) > 0)
+      strcat(str, ", ");
+    formatValue(SpecialValue, max_str, false);
+    sprintf(str + strlen(str), "or \"%s\" [%s]", SpecialStr, max_str);
+  }
 }
 
-  
-template<class T>
-int NumberParameter<T>::getValue(int addr, bool setvalue, Storage &storage) {
-  if (setvalue) {
-    if (!storage.get(addr, Value))
+
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::setMinimum(T minimum) {
+  static_assert(HasRange, "number parameter without NumberRange feature");
+  this->CheckMin = true;
+  this->Minimum = minimum;
+}
+
+
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::setMaximum(T maximum) {
+  static_assert(HasRange, "number parameter without NumberRange feature");
+  this->CheckMax = true;
+  this->Maximum = maximum;
+}
+
+
+template<class T, unsigned F>
+int BaseNumberParameter<T, F>::checkMinMax(T val) {
+  if constexpr (HasRange) {
+    if (this->CheckMin && val < this->Minimum)
+      return -2;
+    if (this->CheckMax && val > this->Maximum)
       return -1;
-    if (this->CheckMin && Value < float(this->Minimum))
-      Value = this->Minimum;
-    if (this->CheckMax && Value > float(this->Maximum))
-      Value = this->Maximum;
   }
-  return addr += sizeof(T);
+  return 1;
 }
 
 
-template<class T>
-NumberPointerParameter<T>::NumberPointerParameter(Menu &menu,
-						  const char *name,
-						  T *number,
-						  const char *format,
-						  const char *unit,
-						  const char *outunit,
-						  const T *selection,
-						  size_t n,
-						  Action::Modes mode) :
-  BaseNumberParameter<T>(menu, name, format, unit, outunit,
-			 selection, n, mode),
-  Value(number) {
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::formatValue(T val, char *str, bool use_special) const {
+  if (use_special && SpecialStr != NULL && strlen(SpecialStr) > 0 &&
+      val == SpecialValue) {
+    strcpy(str, SpecialStr);
+    return;
+  }
+  size_t n = 0;
+  if constexpr (!HasUnits) {
+    if constexpr (std::is_integral_v<T>) {
+      bool negative = val < 0;
+      uint64_t value = negative ? uint64_t(0) - uint64_t(val) : uint64_t(val);
+      n = this->formatDecimal(str, negative, value, 0, 1, 1, this->Format);
+      if (n == 0)
+	n = this->formatFloat(str, double(val), this->Format);
+    }
+    else
+      n = this->formatFloat(str, val, this->Format);
+  }
+  else {
+    if constexpr (std::is_integral_v<T>) {
+      bool negative = val < 0;
+      uint64_t value = negative ? uint64_t(0) - uint64_t(val) : uint64_t(val);
+      uint64_t num = 1;
+      uint64_t den = 1;
+      outRatio(num, den);
+      n = this->formatDecimal(str, negative, value, 0, num, den,
+			      this->Format);
+      if (n == 0)
+	n = this->formatFloat(str, double(val)*double(num)/double(den),
+			      this->Format);
+    }
+    else
+      n = this->formatFloat(str, val * this->OutFactor, this->Format);
+    if (this->Unit[0] != '\0' && n < Parameter::MaxVal) {
+      strncpy(str + n, this->OutUnit, Parameter::MaxVal - n);
+      str[Parameter::MaxVal - 1] = '\0';
+    }
+  }
 }
 
 
-template<class T>
-NumberPointerParameter<T>::NumberPointerParameter(Menu &menu,
-						  const char *name,
-						  T *number,
-						  T minimum, T maximum,
-						  const char *format,
-						  const char *unit,
-						  const char *outunit,
-						  Action::Modes mode) :
-  BaseNumberParameter<T>(menu, name, minimum, maximum, format,
-			 unit, outunit, mode),
-  Value(number) {
+template<class T, unsigned F>
+Parameter::ValueType BaseNumberParameter<T, F>::valueType() const {
+  if constexpr (std::is_floating_point_v<T>)
+    return Parameter::FloatValue;
+  else if constexpr (std::is_signed_v<T>)
+    return Parameter::IntegerValue;
+  else
+    return Parameter::UnsignedValue;
 }
 
 
-template<class T>
-T NumberPointerParameter<T>::value(const char *unit) const {
-  float val = changeUnit(*Value, this->Unit, unit);
-  return (T)val;
+template<class T, unsigned F>
+void BaseNumberParameter<T, F>::typeStr(char *str) const {
+  if constexpr (std::is_integral_v<T>)
+    strcpy(str, "integer");
+  else
+    strcpy(str, "float");
 }
 
 
-template<class T>
-void NumberPointerParameter<T>::setValue(T val) {
+template<class T, unsigned F>
+NumberValueParameter<T, F>::NumberValueParameter(Menu &menu,
+						 const char *name,
+						 T *value,
+						 const char *format,
+						 const char *unit,
+						 const char *outunit,
+						 const T *selection,
+						 size_t n,
+						 Action::Modes mode) :
+  BaseNumberParameter<T, F>(menu, name, format, unit, outunit,
+			    selection, n, mode),
+  Value(value) {
+}
+
+
+template<class T, unsigned F>
+NumberValueParameter<T, F>::NumberValueParameter(Menu &menu,
+						 const char *name,
+						 T *value,
+						 T minimum, T maximum,
+						 const char *format,
+						 const char *unit,
+						 const char *outunit,
+						 Action::Modes mode) :
+  BaseNumberParameter<T, F>(menu, name, minimum, maximum, format,
+			    unit, outunit, mode),
+  Value(value) {
+}
+
+
+template<class T, unsigned F>
+T NumberValueParameter<T, F>::value(const char *unit) const {
+  T val = *Value;
+  this->toUnit(val, unit);
+  return val;
+}
+
+
+template<class T, unsigned F>
+void NumberValueParameter<T, F>::setValue(T val) {
   if (this->checkSelection(val) < 0)
     return;
   if (this->checkMinMax(val) < 0)
     return;
-  *Value = val;
+  this->changeValue(*Value, val);
 }
 
 
-template<class T>
-void NumberPointerParameter<T>::setValue(T val, const char *unit) {
-  float nv = changeUnit((float)val, unit, this->Unit);
+template<class T, unsigned F>
+void NumberValueParameter<T, F>::setValue(T val, const char *unit) {
+  T nv = val;
+  if (!this->fromUnit(nv, unit))
+    return;
   if (this->checkSelection(nv) < 0)
     return;
   if (this->checkMinMax(nv) < 0)
     return;
-  *Value = (T)nv;
+  this->changeValue(*Value, nv);
 }
 
 
-template<class T>
-bool NumberPointerParameter<T>::parseValue(char *val, bool selection) {
+template<class T, unsigned F>
+bool NumberValueParameter<T, F>::parseValue(char *val, bool selection) {
   if (this->disabled(Action::SetValue))
     return true;
   if (strlen(val) == 0)
@@ -1554,39 +2409,55 @@ bool NumberPointerParameter<T>::parseValue(char *val, bool selection) {
   }
   if (this->SpecialStr != NULL && strlen(this->SpecialStr) > 0 &&
       strcmp(val, this->SpecialStr) == 0) {
-    *Value = this->SpecialValue;
+    this->changeValue(*Value, this->SpecialValue);
     return true;
   }
-  float num = atof(val);
-  const char *up = val;
-  for (; *up != '\0' && (isdigit(*up) || *up == '+' || *up == '-' ||
-			   *up == '.' || *up == 'e'); ++up);
-  if (up == val)
+  T nv = 0;
+  if (!this->parseNumber(val, nv))
     return false;
-  char unit[this->MaxUnit] = "";
-  if (strlen(up) == 0 && strlen(this->OutUnit) > 0)
-    strncpy(unit, this->OutUnit, this->MaxUnit);
-  else
-    strncpy(unit, up, this->MaxUnit);
-  unit[this->MaxUnit-1] = '\0';
-  float nv = this->changeUnit(num, unit, this->Unit);
   if (this->checkSelection(nv) < 0)
     return false;
   if (this->checkMinMax(nv) < 0)
     return false;
-  *Value = (T)nv;
+  this->changeValue(*Value, nv);
   return true;
 }
 
 
-template<class T>
-void NumberPointerParameter<T>::valueStr(char *str) const {
-  formatValue(*Value, str);
+template<class T, unsigned F>
+void NumberValueParameter<T, F>::valueStr(char *str) const {
+  this->formatValue(*Value, str);
 }
 
 
-template<class T>
-int NumberPointerParameter<T>::putValue(int addr, Storage &storage) const {
+template<class T, unsigned F>
+bool NumberValueParameter<T, F>::getRaw(void *dest, size_t size) const {
+  if (size != sizeof(T))
+    return false;
+  memcpy(dest, Value, sizeof(T));
+  return true;
+}
+
+
+template<class T, unsigned F>
+bool NumberValueParameter<T, F>::setRaw(const void *src, size_t size) {
+  if (size != sizeof(T) || this->disabled(Action::SetValue))
+    return false;
+  T val;
+  memcpy(&val, src, sizeof(T));
+  if (this->SpecialStr == NULL || val != this->SpecialValue) {
+    if (this->checkSelection(val) < 0)
+      return false;
+    if (this->checkMinMax(val) < 0)
+      return false;
+  }
+  this->changeValue(*Value, val);
+  return true;
+}
+
+
+template<class T, unsigned F>
+int NumberValueParameter<T, F>::putValue(int addr, Storage &storage) const {
   if (storage.put(addr, *Value))
     return addr += sizeof(T);
   else
@@ -1594,19 +2465,119 @@ int NumberPointerParameter<T>::putValue(int addr, Storage &storage) const {
 }
 
   
-template<class T>
-int NumberPointerParameter<T>::getValue(int addr, bool setvalue,
-					Storage &storage) {
-  if (setvalue) {
-    if (!storage.get(addr, *Value))
-      return -1;
-    if (this->CheckMin && *Value < float(this->Minimum))
-      *Value = this->Minimum;
-    if (this->CheckMax && *Value > float(this->Maximum))
-      *Value = this->Maximum;
+template<class T, unsigned F>
+int NumberValueParameter<T, F>::getValue(int addr, size_t size,
+					 Storage &storage) {
+  T val;
+  if (!storage.get(addr, val))
+    return -1;
+  if constexpr (BaseNumberParameter<T, F>::HasRange) {
+    if (this->CheckMin && val < this->Minimum)
+      val = this->Minimum;
+    if (this->CheckMax && val > this->Maximum)
+      val = this->Maximum;
   }
+  this->changeValue(*Value, val);
   return addr += sizeof(T);
 }
 
 
+template<class T, unsigned F>
+void NumberValueParameter<T, F>::resetDefaults() {
+  if (this->disabled(Action::SetValue))
+    return;
+  this->changeValue(*Value, Default);
+}
+
+
+template<class T, unsigned F>
+NumberParameter<T, F>::NumberParameter(Menu &menu, const char *name,
+				       T number, const char *format,
+				       const char *unit,
+				       const char *outunit,
+				       const T *selection, size_t n,
+				       Action::Modes mode) :
+  NumberValueParameter<T, F>(menu, name, &Number, format, unit, outunit,
+			     selection, n, mode),
+  Number(number) {
+  this->Default = number;
+}
+
+
+template<class T, unsigned F>
+NumberParameter<T, F>::NumberParameter(Menu &menu, const char *name,
+				       T number, T minimum, T maximum,
+				       const char *format,
+				       const char *unit,
+				       const char *outunit,
+				       Action::Modes mode) :
+  NumberValueParameter<T, F>(menu, name, &Number, minimum, maximum,
+			     format, unit, outunit, mode),
+  Number(number) {
+  this->Default = number;
+}
+
+
+template<class T, unsigned F>
+NumberPointerParameter<T, F>::NumberPointerParameter(Menu &menu,
+						     const char *name,
+						     T *number,
+						     const char *format,
+						     const char *unit,
+						     const char *outunit,
+						     const T *selection,
+						     size_t n,
+						     Action::Modes mode) :
+  NumberValueParameter<T, F>(menu, name, number, format, unit, outunit,
+			     selection, n, mode) {
+  this->Default = *number;
+}
+
+
+template<class T, unsigned F>
+NumberPointerParameter<T, F>::NumberPointerParameter(Menu &menu,
+						     const char *name,
+						     T *number,
+						     T minimum, T maximum,
+						     const char *format,
+						     const char *unit,
+						     const char *outunit,
+						     Action::Modes mode) :
+  NumberValueParameter<T, F>(menu, name, number, minimum, maximum,
+			     format, unit, outunit, mode) {
+  this->Default = *number;
+}
+
+
+template<class T, unsigned F>
+NumberPointerParameter<T, F>::NumberPointerParameter(Menu &menu,
+						     const char *name,
+						     Shared<T> *number,
+						     const char *format,
+						     const char *unit,
+						     const char *outunit,
+						     const T *selection,
+						     size_t n,
+						     Action::Modes mode) :
+  NumberPointerParameter(menu, name, number->shadow(), format, unit,
+			 outunit, selection, n, mode) {
+  this->Publish = number;
+}
+
+
+template<class T, unsigned F>
+NumberPointerParameter<T, F>::NumberPointerParameter(Menu &menu,
+						     const char *name,
+						     Shared<T> *number,
+						     T minimum, T maximum,
+						     const char *format,
+						     const char *unit,
+						     const char *outunit,
+						     Action::Modes mode) :
+  NumberPointerParameter(menu, name, number->shadow(), minimum, maximum,
+			 format, unit, outunit, mode) {
+  this->Publish = number;
+}
+
+
 #endif
@@ -0,0 +1,128 @@
+/*
+  Shared - Double-buffered values that can be read from interrupts.
+
+  Pointer parameters write straight into application variables.
+  Variables that are also read from interrupt service routines (for
+  example a sampling rate used by a timer ISR or a file name used by a
+  DMA callback) might then be read while only half of their bytes have
+  been updated.
+
+  Bind such a variable as a Shared<T> to a pointer parameter instead.
+  The parameter then writes into a shadow copy of the value, and
+  publishes it by copying it into the currently unused one of two
+  buffers and switching the index of the published buffer with a
+  single byte write. Reading the value via value() just reads the
+  published buffer. It is wait-free and always consistent, as long as
+  the ISR is not interrupted by the code writing the value (single core
+  microcontrollers).
+
+  Classes:
+
+  - SharedValue: Base class publishing a shadow copy of a value.
+  - Shared<T>: A double-buffered value of type T.
+  - Shared<char[N]>: A double-buffered string of size N.
+*/
+
+#ifndef Shared_h
+#define Shared_h
+
+
+#include <Arduino.h>
+
+
+/* Base class publishing a shadow copy of a value. */
+class SharedValue {
+
+ public:
+
+  /* Initialize with the first buffer published. */
+  SharedValue() : Index(0) {};
+
+  /* Copy the shadow value into the unused buffer and publish it. */
+  virtual void publish() = 0;
+
+
+ protected:
+
+  /* Switch to the other buffer after it has been completely written. */
+  void flip() {
+    __atomic_signal_fence(__ATOMIC_RELEASE);
+    Index = 1 - Index;
+  };
+
+  volatile uint8_t Index;
+
+};
+
+
+/* A double-buffered value of type T. */
+template<class T>
+class Shared : public SharedValue {
+
+ public:
+
+  /* Initialize with value val. */
+  Shared(T val=T()) : Shadow(val) { Buffer[0] = val; Buffer[1] = val; };
+
+  /* The published value. Safe to be called from an ISR. */
+  T value() const { return Buffer[Index]; };
+
+  /* Set and publish the value. */
+  void setValue(T val) { Shadow = val; publish(); };
+
+  /* The shadow copy to be modified by the pointer parameter. */
+  T *shadow() { return &Shadow; };
+
+  /* Copy the shadow value into the unused buffer and publish it. */
+  virtual void publish() {
+    Buffer[1 - Index] = Shadow;
+    flip();
+  };
+
+
+ protected:
+
+  T Shadow;
+  T Buffer[2];
+
+};
+
+
+/* A double-buffered string of size N. */
+template<int N>
+class Shared<char[N]> : public SharedValue {
+
+ public:
+
+  /* Initialize with string str. */
+  Shared(const char *str="") { setValue(str); };
+
+  /* The published string. Safe to be called from an ISR. */
+  const char *value() const { return Buffer[Index]; };
+
+  /* Set and publish the string. */
+  void setValue(const char *str) {
+    strncpy(Shadow, str, N);
+    Shadow[N-1] = '\0';
+    publish();
+  };
+
+  /* The shadow copy to be modified by the pointer parameter. */
+  char (*shadow())[N] { return &Shadow; };
+
+  /* Copy the shadow string into the unused buffer and publish it. */
+  virtual void publish() {
+    memcpy(Buffer[1 - Index], Shadow, N);
+    flip();
+  };
+
+
+ protected:
+
+  char Shadow[N];
+  char Buffer[2][N];
+
+};
+
+
+#endif
@@ -6,7 +6,7 @@ Storage::Storage() {
 }
 
 
-uint16_t Storage::length() {
+uint32_t Storage::length() {
   return EEPROM.length();
 }
 
@@ -27,6 +27,18 @@ int Storage::update(unsigned int idx, const uint8_t *src, size_t len) {
 }
 
 
+bool Storage::get(int idx, void *dest, size_t len) {
+  int r = read(idx, (uint8_t *)dest, len);
+  return (r == (int)len);
+}
+
+
+bool Storage::put(int idx, const void *src, size_t len) {
+  int r = update(idx, (const uint8_t *)src, len);
+  return (r == (int)len);
+}
+
+
 uint32_t Storage::crc(int addr0, int addr1) {
   // Adapted from https://docs.arduino.cc/learn/programming/eeprom-guide/
   
@@ -39,18 +51,67 @@ uint32_t Storage::crc(int addr0, int addr1) {
 
   if (addr0 < 0)
     addr0 = 0;
-  if (addr1 > length())
+  if (addr1 > (int)length())
     addr1 = length();
-  uint8_t buffer[addr1 - addr0];
-  read(addr0, buffer, addr1 - addr0);
+  const int nbuffer = 64;
+  uint8_t buffer[nbuffer];
   uint8_t val = 0;
   uint32_t crc = ~0L;
-  for (int index = 0; index < addr1 - addr0; ++index) {
-    val = buffer[index];
-    crc = crc_table[(crc ^ val) & 0x0f] ^ (crc >> 4);
-    crc = crc_table[(crc ^ (val >> 4)) & 0x0f] ^ (crc >> 4);
-    crc = ~crc;
+  for (int addr = addr0; addr < addr1; addr += nbuffer) {
+    int n = addr1 - addr < nbuffer ? addr1 - addr : nbuffer;
+    read(addr, buffer, n);
+    for (int index = 0; index < n; ++index) {
+      val = buffer[index];
+      crc = crc_table[(crc ^ val) & 0x0f] ^ (crc >> 4);
+      crc = crc_table[(crc ^ (val >> 4)) & 0x0f] ^ (crc >> 4);
+      crc = ~crc;
+    }
   }
   return crc;
 }
 
+
+RAMStorage::RAMStorage(uint8_t *buffer, size_t size) :
+  Buffer(buffer),
+  Size(buffer == NULL ? 0 : size),
+  Own(false) {
+}
+
+
+RAMStorage::RAMStorage(size_t size) :
+  Buffer((uint8_t *)malloc(size)),
+  Size(0),
+  Own(true) {
+  if (Buffer != NULL) {
+    Size = size;
+    memset(Buffer, 0xff, Size);
+  }
+}
+
+
+RAMStorage::~RAMStorage() {
+  if (Own)
+    free(Buffer);
+}
+
+
+uint32_t RAMStorage::length() {
+  return Size;
+}
+
+
+int RAMStorage::read(unsigned int idx, uint8_t *dest, size_t len) {
+  if (idx + len > Size)
+    return -1;
+  memcpy(dest, Buffer + idx, len);
+  return len;
+}
+
+  
+int RAMStorage::update(unsigned int idx, const uint8_t *src, size_t len) {
+  if (idx + len > Size)
+    return -1;
+  memcpy(Buffer + idx, src, len);
+  return len;
+}
+
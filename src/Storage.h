@@ -12,6 +12,9 @@
   When reimplementing this class for another EEPROM memory, for example,
   one that is accesible via I2C bus, then reimplement the length(),
   read(), and update() functions.
+
+  The RAMStorage class provides the Storage interface for a buffer in RAM,
+  see FileStorage for storage in a file on SD card.
 */
 
 #ifndef Storage_h
@@ -28,8 +31,11 @@ class Storage {
   // Constructor using internal EEPROM.
   Storage();
 
+  // Destructor.
+  virtual ~Storage() {};
+
   // Size of storage in bytes.
-  virtual uint16_t length();
+  virtual uint32_t length();
 
   // Read variable t at index idx.
   // Return true on success.
@@ -41,9 +47,22 @@ class Storage {
   template<typename T>
     bool put(int idx, const T &t);
 
+  // Read len bytes at index idx into buffer dest.
+  // Return true on success.
+  bool get(int idx, void *dest, size_t len);
+
+  // Write len bytes from buffer src to index idx.
+  // Return true on success.
+  bool put(int idx, const void *src, size_t len);
+
   // Compute CRC sum.
   uint32_t crc(int addr0, int addr1);
 
+  // Commit all written data to the storage memory.
+  // Call after a complete set of records has been written.
+  // Default implementation does nothing.
+  virtual void flush() {};
+
 
 protected:
 
@@ -61,6 +80,49 @@ protected:
 static Storage EEPROMStorage __attribute__ ((unused));
 
 
+class RAMStorage : public Storage {
+
+ public:
+
+  // Constructor using buffer of size bytes.
+  // Only the pointer to the buffer is stored.
+  RAMStorage(uint8_t *buffer, size_t size);
+
+  // Constructor allocating a buffer of size bytes
+  // that is initialized to 0xff, like erased EEPROM.
+  RAMStorage(size_t size);
+
+  // Destructor. Frees the buffer, if it was allocated by the constructor.
+  virtual ~RAMStorage();
+
+  // No copies, since the buffer might be owned.
+  RAMStorage(const RAMStorage &) = delete;
+  RAMStorage &operator=(const RAMStorage &) = delete;
+
+  // Size of storage in bytes.
+  virtual uint32_t length();
+
+  // The buffer holding the data.
+  uint8_t *buffer() { return Buffer; };
+
+
+protected:
+
+  // Read len bytes from buffer at idx into dest.
+  // Return number of bytes actually read, negative number on error.
+  virtual int read(unsigned int idx, uint8_t *dest, size_t len);
+  
+  // Write a len bytes from src to buffer at idx.
+  // Return number of bytes actually written, negative number on error..
+  virtual int update(unsigned int idx, const uint8_t *src, size_t len);
+
+  uint8_t *Buffer;
+  size_t Size;
+  bool Own;
+
+};
+
+
 template<typename T>
 bool Storage::get(int idx, T &t) {
   int r = read(idx, (uint8_t *) &t, sizeof(T));